@@ -0,0 +1,24 @@
+#ifndef Arduino_h
+#define Arduino_h
+
+// The part of the Arduino core that BatchedLcd and LiquidCrystal_I2C use, so
+// host builds link the board's LCD code unchanged (see Wire.h and
+// arduino_native.cpp for the bus it talks to).
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <FlashString.h>
+#include "Print.h"
+
+#define pgm_read_byte_near pgm_read_byte
+
+// The binary constants LiquidCrystal_I2C.h spells its pin masks with
+#define B00000001 1
+#define B00000010 2
+#define B00000100 4
+
+// The fake bus delivers every transaction at once, so nothing needs to wait
+inline void delay(unsigned long) {}
+inline void delayMicroseconds(unsigned int) {}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef FakeHal_h
+#define FakeHal_h
+
+#include <stdint.h>
+#include <Irrigation.h>
+#include "VirtualLcd.h"
+
+class BatchedLcd;
+
+// Fake hardware behind IrrigationHal.h for host builds. The clock only moves
+// when the driver (or a halDelay() inside the core) advances it, so a
+// simulated day runs as fast as the core can tick.
+namespace fake {
+
+const int EEPROM_SIZE = 1024;
+const int PIN_COUNT = 128;        // Zone.pin is 7 bits
+const unsigned long LOOP_MS = 100; // loop() period on the board
+const uint8_t LCD_ADDRESS = 0x27;   // The backpack, as on the board
+
+extern unsigned long millis;      // Milliseconds since boot
+extern uint32_t bootUnixtime;     // RTC time at millis == 0
+extern bool buttonDown[3];        // Indexed by HalButton
+extern bool alarmOn;
+extern bool valveOn[PIN_COUNT];    // Indexed by valve pin
+extern uint8_t eeprom[EEPROM_SIZE];
+extern unsigned long eepromWrites;  // Bytes actually written
+extern unsigned long eepromCellWrites[EEPROM_SIZE];
+extern long eepromPowerCut;         // Bytes still written before a simulated power cut, -1 for never
+extern BatchedLcd lcd;              // The board's LCD driver behind `frame`
+extern VirtualLcd panel;            // The glass it drives, bus traffic decoded
+extern bool logToStdout;
+extern uint32_t idleUntil;          // wakeTime from the last halIdle(), 0 if busy
+
+// Power-on state: erased EEPROM, buttons released, outputs off
+void reset(uint32_t unixtime);
+// Power-on state with the EEPROM kept, as after a power cut
+void powerCycle(uint32_t unixtime);
+void advance(unsigned long ms);
+// Milliseconds until the core next has something to do: the next spray start
+// of an idle zone, the end of an alarm pulse or of a run, or one loop period
+// while a run starts or closes; 0 if nothing is scheduled. Drivers that skip
+// the clock ahead by this instead of ticking see the same runs.
+unsigned long untilNextEvent();
+// Queue a gesture for halButtonEvent()
+void pressButton(HalButton button, HalGesture gesture);
+// Queue a gesture that the debouncer hands over at millis == at
+void pressButtonAt(unsigned long at, HalButton button, HalGesture gesture);
+// The pause at the end of a pass on a board that does not sleep, as in
+// IrrigationBoard's halIdle(): LOOP_MS, cut short when a gesture is ready.
+// Returns the milliseconds waited.
+unsigned long idle();
+
+}
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef Print_h
+#define Print_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Arduino's Print, cut down to the writes LiquidCrystal_I2C and BatchedLcd
+// make on host builds
+class Print {
+public:
+  virtual ~Print() {}
+
+  virtual size_t write(uint8_t value) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  size_t write(const char *text) {
+    return text ? write((const uint8_t *)text, strlen(text)) : 0;
+  }
+
+  size_t print(const char *text) {
+    return write(text);
+  }
+};
+
+#endif
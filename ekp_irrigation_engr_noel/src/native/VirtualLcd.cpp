@@ -0,0 +1,134 @@
+#include <string.h>
+#include "VirtualLcd.h"
+
+// Expander pins and HD44780 instructions, as in LiquidCrystal_I2C.h
+const uint8_t RS = 0x01;
+const uint8_t EN = 0x04;
+const uint8_t BACKLIGHT = 0x08;
+
+const uint8_t LCD_CLEARDISPLAY = 0x01;
+const uint8_t LCD_RETURNHOME = 0x02;
+const uint8_t LCD_ENTRYMODESET = 0x04;
+const uint8_t LCD_DISPLAYCONTROL = 0x08;
+const uint8_t LCD_CURSORSHIFT = 0x10;
+const uint8_t LCD_FUNCTIONSET = 0x20;
+const uint8_t LCD_SETCGRAMADDR = 0x40;
+const uint8_t LCD_SETDDRAMADDR = 0x80;
+
+VirtualLcd::VirtualLcd() {
+  reset();
+}
+
+void VirtualLcd::reset() {
+  // The expander's outputs come up high
+  _port = 0xFF;
+  _fourBit = false;
+  _highNibble = true;
+  _nibble = 0;
+  _address = 0;
+  _increment = true;
+  _cgram = false;
+  _displayOn = false;
+  memset(_ddram, ' ', sizeof(_ddram));
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+// One I2C write through the expander into the controller. The controller
+// latches D4-D7 and RS on each falling edge of En: one latch is a whole
+// instruction in the 8-bit interface (the low data pins are not wired and read
+// as 0), and half a byte, high half first, in the 4-bit interface.
+void VirtualLcd::transaction(const uint8_t *data, size_t size) {
+  _stats.transactions++;
+  _stats.bytes += 1 + size;
+
+  for (size_t i = 0; i < size; i++) {
+    uint8_t previous = _port;
+    _port = data[i];
+    if (!(previous & EN) || (_port & EN)) {
+      continue;
+    }
+    _stats.enablePulses++;
+
+    // Data and RS as held across the edge
+    uint8_t nibble = previous & 0xF0;
+    bool isData = previous & RS;
+    if (!_fourBit) {
+      execute(nibble, isData);
+    } else if (_highNibble) {
+      _nibble = nibble;
+      _highNibble = false;
+    } else {
+      _highNibble = true;
+      execute(_nibble | nibble >> 4, isData);
+    }
+  }
+}
+
+void VirtualLcd::execute(uint8_t value, bool data) {
+  if (data) {
+    if (!_cgram) {
+      _ddram[_address] = value;
+    }
+  } else if (value & LCD_SETDDRAMADDR) {
+    _address = value & 0x7F;
+    _cgram = false;
+    return;
+  } else if (value & LCD_SETCGRAMADDR) {
+    _cgram = true;
+    return;
+  } else if (value & LCD_FUNCTIONSET) {
+    // DL: 8-bit interface when set
+    _fourBit = !(value & 0x10);
+    _highNibble = true;
+    return;
+  } else if (value & LCD_CURSORSHIFT) {
+    return;
+  } else if (value & LCD_DISPLAYCONTROL) {
+    _displayOn = value & 0x04;
+    return;
+  } else if (value & LCD_ENTRYMODESET) {
+    _increment = value & 0x02;
+    return;
+  } else if (value & LCD_RETURNHOME) {
+    _address = 0;
+    _cgram = false;
+    return;
+  } else if (value & LCD_CLEARDISPLAY) {
+    memset(_ddram, ' ', sizeof(_ddram));
+    _address = 0;
+    _increment = true;
+    _cgram = false;
+    return;
+  } else {
+    return;
+  }
+
+  // A data write moves the address counter; each line holds 40 characters
+  // and the counter runs from the end of one line into the other
+  if (_cgram) {
+    return;
+  }
+  if (_increment) {
+    _address = _address == 0x27 ? 0x40 : _address == 0x67 ? 0x00 : _address + 1;
+  } else {
+    _address = _address == 0x40 ? 0x27 : _address == 0x00 ? 0x67 : _address - 1;
+  }
+}
+
+const char *VirtualLcd::row(uint8_t row) const {
+  memcpy(_row, &_ddram[row == 0 ? 0x00 : 0x40], LCD_FRAME_COLS);
+  _row[LCD_FRAME_COLS] = '\0';
+  return _row;
+}
+
+bool VirtualLcd::backlight() const {
+  return _port & BACKLIGHT;
+}
+
+bool VirtualLcd::displayOn() const {
+  return _displayOn;
+}
+
+const LcdBusStats &VirtualLcd::stats() const {
+  return _stats;
+}
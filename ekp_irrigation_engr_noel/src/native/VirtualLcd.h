@@ -0,0 +1,59 @@
+#ifndef VirtualLcd_h
+#define VirtualLcd_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <LcdFrame.h>
+
+// Bus traffic to the LCD backpack since reset()
+struct LcdBusStats {
+  unsigned long transactions;  // I2C write transactions
+  unsigned long bytes;         // Address and data bytes on the wire
+  unsigned long enablePulses;  // Falling edges of En, one per nibble latched
+};
+
+// Virtual 16x2 HD44780 behind a PCF8574 backpack, for host builds.
+//
+// The fake TWI queue (arduino_native.cpp) hands it every transaction the
+// board's BatchedLcd and LiquidCrystal_I2C send to the backpack. Each byte
+// goes through a model of the panel: the controller latches the data pins on
+// the falling edge of En, starts in the 8-bit interface after power-up,
+// switches to nibbles on the function set that clears DL, and executes
+// commands and DDRAM writes like the real chip. The screen seen in a test is
+// what the glass would show, not what was asked for.
+//
+// PCF8574 pins: P0 RS, P1 RW, P2 En, P3 backlight, P4-P7 D4-D7.
+class VirtualLcd {
+public:
+  VirtualLcd();
+
+  // Power-on state: 8-bit interface, blank DDRAM, counters cleared
+  void reset();
+
+  // One I2C write to the expander
+  void transaction(const uint8_t *data, size_t size);
+
+  // Row of the screen as shown, LCD_FRAME_COLS characters and a NUL
+  const char *row(uint8_t row) const;
+  bool backlight() const;
+  bool displayOn() const;
+  const LcdBusStats &stats() const;
+
+private:
+  void execute(uint8_t value, bool data);
+
+  uint8_t _port;           // Expander output latch
+  bool _fourBit;
+  bool _highNibble;        // Next nibble is the high half of a byte
+  uint8_t _nibble;         // High half received so far
+  uint8_t _address;        // DDRAM address counter
+  bool _increment;
+  bool _cgram;             // Data goes to CGRAM, not DDRAM
+  bool _displayOn;
+  char _ddram[0x80];
+  mutable char _row[LCD_FRAME_COLS + 1];
+
+  LcdBusStats _stats;
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef Wire_h
+#define Wire_h
+
+#include <stdint.h>
+#include "Arduino.h"
+
+// Wire on host builds. On the board TwiWire.cpp turns every Wire transmission
+// into a blocking transaction on the TWI queue; this does the same on the fake
+// queue in arduino_native.cpp, so the stock LiquidCrystal_I2C calls reach the
+// same device as BatchedLcd's batches, in order.
+class TwoWire {
+public:
+  TwoWire();
+
+  void begin();
+  void beginTransmission(uint8_t address);
+  size_t write(uint8_t value);
+  // Returns 0, or the TWI_* error of the transaction
+  uint8_t endTransmission();
+
+private:
+  uint8_t _address;
+  uint8_t _buffer[32];  // BUFFER_LENGTH of the AVR Wire
+  uint8_t _length;
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,81 @@
+// Host side of the Arduino headers in this directory: Print, Wire and the TWI
+// queue. The queue has no bus; each transaction completes inside submit(),
+// written to the device at its address, which is only the virtual panel.
+
+#include <TwiQueue.h>
+#include <Wire.h>
+#include "FakeHal.h"
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  while (size--) {
+    n += write(*buffer++);
+  }
+  return n;
+}
+
+TwoWire Wire;
+
+TwoWire::TwoWire() : _address(0), _length(0) {
+}
+
+void TwoWire::begin() {
+  twiQueue.begin();
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+  _address = address;
+  _length = 0;
+}
+
+size_t TwoWire::write(uint8_t value) {
+  if (_length >= sizeof(_buffer)) {
+    return 0;
+  }
+  _buffer[_length++] = value;
+  return 1;
+}
+
+uint8_t TwoWire::endTransmission() {
+  TwiTransaction transaction = { _address, _buffer, _length, 0, 0, 0, 0, TWI_PENDING };
+  return twiQueue.transfer(transaction);
+}
+
+TwiQueue twiQueue;
+
+TwiQueue::TwiQueue() : _head(0), _count(0), _index(0), _reading(false) {
+}
+
+void TwiQueue::begin() {
+}
+
+void TwiQueue::setFrequency(uint32_t) {
+}
+
+// The backpack is only ever written; reads are not modelled
+void TwiQueue::submit(TwiTransaction &transaction) {
+  if (transaction.address == fake::LCD_ADDRESS) {
+    fake::panel.transaction(transaction.writeData, transaction.writeLength);
+    transaction.status = TWI_OK;
+  } else {
+    transaction.status = TWI_NACK_ADDRESS;
+  }
+  if (transaction.done) {
+    transaction.done(transaction);
+  }
+}
+
+uint8_t TwiQueue::transfer(TwiTransaction &transaction) {
+  submit(transaction);
+  return transaction.status;
+}
+
+void TwiQueue::wait(TwiTransaction &) {
+}
+
+bool TwiQueue::busy() {
+  return false;
+}
+
+void TwiQueue::flush() {
+}
@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <string.h>
+#include <BatchedLcd.h>
+#include "FakeHal.h"
+
+namespace fake {
+
+unsigned long millis = 0;
+uint32_t bootUnixtime = 0;
+bool buttonDown[3];
+bool alarmOn = false;
+bool valveOn[PIN_COUNT];
+uint8_t eeprom[EEPROM_SIZE];
+unsigned long eepromWrites = 0;
+unsigned long eepromCellWrites[EEPROM_SIZE];
+long eepromPowerCut = -1;
+bool logToStdout = false;
+uint32_t idleUntil = 0;
+
+// Gestures waiting for halButtonEvent()
+const int BUTTON_QUEUE_SIZE = 8;
+HalButtonEvent buttonQueue[BUTTON_QUEUE_SIZE];
+unsigned long buttonReadyAt[BUTTON_QUEUE_SIZE];
+int buttonQueued = 0;
+
+VirtualLcd panel;
+BatchedLcd lcd(LCD_ADDRESS, LCD_FRAME_COLS, LCD_FRAME_ROWS);
+
+void reset(uint32_t unixtime) {
+  millis = 0;
+  bootUnixtime = unixtime;
+  memset(buttonDown, 0, sizeof(buttonDown));
+  buttonQueued = 0;
+  alarmOn = false;
+  memset(valveOn, 0, sizeof(valveOn));
+  memset(eeprom, 0xFF, sizeof(eeprom));
+  eepromWrites = 0;
+  memset(eepromCellWrites, 0, sizeof(eepromCellWrites));
+  eepromPowerCut = -1;
+  // A blank panel, initialized as boardSetup() does; the frame redraws it all
+  panel.reset();
+  lcd.init();
+  lcd.backlight();
+  frame.invalidate();
+}
+
+void powerCycle(uint32_t unixtime) {
+  uint8_t kept[EEPROM_SIZE];
+  memcpy(kept, eeprom, sizeof(eeprom));
+  reset(unixtime);
+  memcpy(eeprom, kept, sizeof(eeprom));
+}
+
+void advance(unsigned long ms) {
+  millis += ms;
+}
+
+unsigned long untilNextEvent() {
+  uint32_t now = halNow().unixtime;
+  unsigned long step = 0;
+  for (uint8_t i = 0; i < zoneCount; i++) {
+    const ZoneRun &run = zoneRuns[i];
+    unsigned long until;
+    if (run.state == RUN_IDLE) {
+      // Queued and running zones pick their next slot when the run ends
+      if (!zones[i].enabled) {
+        continue;
+      }
+      until = run.nextSprayTime > now ? (run.nextSprayTime - now) * 1000UL - millis % 1000 : LOOP_MS;
+    } else if (run.state == RUN_PENDING) {
+      // Waits for another zone's run
+      continue;
+    } else {
+      uint32_t elapsed = halMillis() - run.stateStart;
+      uint32_t length = run.state == RUN_ALARM ? 1000 : run.state == RUN_VALVE_OPEN ? run.runMinutes * 60000UL : 0;
+      until = elapsed < length ? length - elapsed : LOOP_MS;
+    }
+    if (step == 0 || until < step) {
+      step = until;
+    }
+  }
+  if (step == 0 && irrigationBusy()) {
+    step = LOOP_MS;
+  }
+  return step;
+}
+
+void pressButton(HalButton button, HalGesture gesture) {
+  pressButtonAt(millis, button, gesture);
+}
+
+void pressButtonAt(unsigned long at, HalButton button, HalGesture gesture) {
+  if (buttonQueued < BUTTON_QUEUE_SIZE) {
+    buttonQueue[buttonQueued].button = button;
+    buttonQueue[buttonQueued].gesture = gesture;
+    buttonReadyAt[buttonQueued] = at;
+    buttonQueued++;
+  }
+}
+
+unsigned long idle() {
+  unsigned long wait = LOOP_MS;
+  if (buttonQueued > 0) {
+    wait = buttonReadyAt[0] > millis ? buttonReadyAt[0] - millis : 0;
+    if (wait > LOOP_MS) {
+      wait = LOOP_MS;
+    }
+  }
+  advance(wait);
+  return wait;
+}
+
+}
+
+LcdFrame frame(fake::lcd);
+
+// Wraps after 49.7 days, like millis() on the board
+unsigned long halMillis() {
+  return (uint32_t)fake::millis;
+}
+
+void halDelay(unsigned long ms) {
+  fake::advance(ms);
+}
+
+ClockTime halNow() {
+  ClockTime time;
+  time.unixtime = fake::bootUnixtime + fake::millis / 1000;
+  time.hour = (time.unixtime / 3600UL) % 24;
+  time.minute = (time.unixtime / 60UL) % 60;
+  time.second = time.unixtime % 60;
+  return time;
+}
+
+void halIdle(uint32_t wakeTime) {
+  // The driver advances the clock itself; just record what the core asked for
+  fake::idleUntil = wakeTime;
+}
+
+bool halButtonDown(HalButton button) {
+  return fake::buttonDown[button];
+}
+
+bool halButtonEvent(HalButtonEvent &event) {
+  if (fake::buttonQueued == 0 || fake::buttonReadyAt[0] > fake::millis) {
+    return false;
+  }
+  event = fake::buttonQueue[0];
+  fake::buttonQueued--;
+  memmove(fake::buttonQueue, fake::buttonQueue + 1, fake::buttonQueued * sizeof(HalButtonEvent));
+  memmove(fake::buttonReadyAt, fake::buttonReadyAt + 1, fake::buttonQueued * sizeof(unsigned long));
+  return true;
+}
+
+void halSetAlarm(bool on) {
+  fake::alarmOn = on;
+}
+
+void halSetValve(uint8_t pin, bool on) {
+  fake::valveOn[pin] = on;
+}
+
+size_t halStorageSize() {
+  return fake::EEPROM_SIZE;
+}
+
+void halStorageRead(int address, void *data, size_t size) {
+  memcpy(data, &fake::eeprom[address], size);
+}
+
+void halStorageWrite(int address, const void *data, size_t size) {
+  const uint8_t *bytes = (const uint8_t *)data;
+  for (size_t i = 0; i < size; i++) {
+    if (fake::eeprom[address + i] != bytes[i]) {
+      if (fake::eepromPowerCut == 0) {
+        return;
+      }
+      if (fake::eepromPowerCut > 0) {
+        fake::eepromPowerCut--;
+      }
+      fake::eeprom[address + i] = bytes[i];
+      fake::eepromWrites++;
+      fake::eepromCellWrites[address + i]++;
+    }
+  }
+}
+
+void halLog(const char *message) {
+  if (fake::logToStdout) {
+    printf("[%10lu ms] %s\n", fake::millis, message);
+  }
+}
@@ -0,0 +1,695 @@
+// Host driver for the irrigation core: replays a few days of each schedule
+// against the fake HAL, checks the runs against a reference model of the
+// original minute-polling firmware and reports tick throughput. Unlike the
+// original, the model starts no run on the window's closing minute, where
+// it would not be clipped to the window.
+//
+//   pio run -e native && .pio/build/native/program
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "FakeHal.h"
+
+const uint32_t SIM_EPOCH = 1735689600UL;  // 2025-01-01 00:00:00
+const unsigned long TICK_MS = 100;        // loop() period on the board
+const int SIM_DAYS = 3;
+const int MAX_RUNS = 512;
+const uint8_t VALVE_PIN = 12;
+
+struct Schedule {
+  int sprayMinutes;
+  int sprayDuration;
+  int startHour;
+  int startMinute;
+  int endHour;
+  int endMinute;
+  uint32_t bootOffset;  // Seconds after midnight when the board powers up
+};
+
+struct Run {
+  uint32_t start;  // RTC unixtime the valve opened
+  int minutes;     // Valve-open time after the alarm pulse
+};
+
+static const Schedule schedules[] = {
+  { 360, 30, 6, 0, 18, 0, 0 },         // Factory defaults
+  { 30, 45, 22, 0, 2, 0, 79230 },      // Window past midnight, runs longer than the interval
+  { 90, 120, 0, 0, 0, 0, 3600 },       // Whole-day window
+  { 60, 10, 8, 15, 8, 45, 29730 },     // Window shorter than the interval
+  { 1440, 5, 12, 0, 11, 59, 43230 },   // Once a day, booting inside the run minute
+  { 30, 1, 0, 0, 23, 30, 0 },          // Densest schedule the menu allows
+};
+
+static double wallSeconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// The original firmware: poll every minute, start a run when the minute is a
+// spray interval inside the window (its closing minute excluded), and block
+// for the whole run
+static int referenceRuns(const Schedule &s, uint32_t from, uint32_t to, Run *runs) {
+  int startTimeInMinutes = s.startHour * 60 + s.startMinute;
+  int endTimeInMinutes = s.endHour * 60 + s.endMinute;
+  int count = 0;
+  uint32_t t = from;
+
+  while (t < to && count < MAX_RUNS) {
+    int currentTimeInMinutes = (t / 60) % (24 * 60);
+    bool isWithinTimeWindow;
+    if (endTimeInMinutes <= startTimeInMinutes) {
+      isWithinTimeWindow = currentTimeInMinutes >= startTimeInMinutes || currentTimeInMinutes < endTimeInMinutes;
+    } else {
+      isWithinTimeWindow = currentTimeInMinutes >= startTimeInMinutes && currentTimeInMinutes < endTimeInMinutes;
+    }
+    int minutesSinceStart = (currentTimeInMinutes - startTimeInMinutes + 24 * 60) % (24 * 60);
+
+    if (isWithinTimeWindow && minutesSinceStart % s.sprayMinutes == 0) {
+      int maxDuration;
+      if (endTimeInMinutes <= currentTimeInMinutes) {
+        maxDuration = 24 * 60 - currentTimeInMinutes + endTimeInMinutes;
+      } else {
+        maxDuration = endTimeInMinutes - currentTimeInMinutes;
+      }
+      runs[count].start = t;
+      runs[count].minutes = s.sprayDuration < maxDuration ? s.sprayDuration : maxDuration;
+      t += 1 + runs[count].minutes * 60UL;
+      count++;
+    } else {
+      t = (t / 60 + 1) * 60;
+    }
+  }
+  return count;
+}
+
+static Zone zoneFor(const Schedule &s, uint8_t pin) {
+  Zone zone = { pin, 1, (uint8_t)s.sprayDuration, (uint16_t)s.sprayMinutes,
+                (uint16_t)(s.startHour * 60 + s.startMinute), (uint16_t)(s.endHour * 60 + s.endMinute) };
+  return zone;
+}
+
+// Boot the core with the given settings and tick it like loop() does
+static int simulatedRuns(const Schedule &s, uint32_t from, uint32_t to, Run *runs,
+                         unsigned long *ticks, unsigned long *maxLatencyMs) {
+  fake::reset(from);
+  Zone zone = zoneFor(s, VALVE_PIN);
+  irrigationSetup(&zone, 1);
+
+  int count = 0;
+  bool valveWasOn = false;
+  unsigned long openedAt = 0;
+  *ticks = 0;
+  *maxLatencyMs = 0;
+
+  while (halNow().unixtime < to) {
+    irrigationLoop();
+    (*ticks)++;
+
+    bool valveOn = fake::valveOn[VALVE_PIN];
+    if (valveOn && !valveWasOn && count < MAX_RUNS) {
+      openedAt = fake::millis;
+      runs[count].start = halNow().unixtime;
+      // Time from the slot boundary to the valve opening; a slot the board
+      // booted into is late by design and not counted
+      uint32_t lastSprayTime = zoneRuns[0].lastSprayTime;
+      if (lastSprayTime >= from) {
+        unsigned long latency = (unsigned long)((fake::bootUnixtime * 1000ULL + fake::millis) - lastSprayTime * 1000ULL);
+        if (latency > *maxLatencyMs) {
+          *maxLatencyMs = latency;
+        }
+      }
+    } else if (!valveOn && valveWasOn) {
+      runs[count].minutes = (fake::millis - openedAt - 1000) / 60000UL;
+      count++;
+    }
+    valveWasOn = valveOn;
+
+    fake::advance(TICK_MS);
+  }
+  return count;
+}
+
+// Fill the zone table with one schedule on every zone and check the run
+// policy: sequential runs never overlap, parallel runs open all valves
+// together, and no zone loses a run either way
+static bool multiZoneRuns(const Schedule &s, RunPolicy policy, unsigned long *ticks, double *wall) {
+  static Run expected[MAX_RUNS];
+  uint32_t from = SIM_EPOCH + s.bootOffset;
+  uint32_t to = from + SIM_DAYS * 86400UL;
+  int expectedCount = referenceRuns(s, from, to, expected);
+
+  Zone table[MAX_ZONES];
+  for (uint8_t i = 0; i < MAX_ZONES; i++) {
+    table[i] = zoneFor(s, 2 + i);
+  }
+  fake::reset(from);
+  runPolicy = policy;
+  irrigationSetup(table, MAX_ZONES);
+
+  int runs[MAX_ZONES] = { 0 };
+  bool wasOn[MAX_ZONES] = { false };
+  int maxOpen = 0;
+  *ticks = 0;
+  double wallStart = wallSeconds();
+
+  while (halNow().unixtime < to) {
+    irrigationLoop();
+    (*ticks)++;
+
+    int open = 0;
+    for (uint8_t i = 0; i < MAX_ZONES; i++) {
+      bool on = fake::valveOn[table[i].pin];
+      if (on && !wasOn[i]) {
+        runs[i]++;
+      }
+      wasOn[i] = on;
+      open += on;
+    }
+    if (open > maxOpen) {
+      maxOpen = open;
+    }
+    fake::advance(TICK_MS);
+  }
+  *wall = wallSeconds() - wallStart;
+  runPolicy = RUN_SEQUENTIAL;
+
+  bool ok = maxOpen == (policy == RUN_SEQUENTIAL ? 1 : MAX_ZONES);
+  for (uint8_t i = 0; i < MAX_ZONES; i++) {
+    ok = ok && runs[i] == expectedCount;
+  }
+  printf("%d zones %-25s %5d %5s %12.0f %8d open\n", MAX_ZONES, policy == RUN_SEQUENTIAL ? "sequential" : "parallel",
+         runs[0] * MAX_ZONES, ok ? "yes" : "NO", *ticks / *wall, maxOpen);
+  return ok;
+}
+
+// Save the settings over and over, one edit at a time, the way the menu
+// does, then check that the wear is spread over the journal and that a
+// reboot, even after a save torn by a power cut, finds the right record
+static bool journalRuns(int saves) {
+  fake::reset(SIM_EPOCH);
+  Zone factory = zoneFor(schedules[0], VALVE_PIN);
+  irrigationSetup(&factory, 1);
+
+  for (int i = 0; i < saves; i++) {
+    zones[0].duration = 1 + i % 120;
+    saveSettings();
+  }
+  unsigned long maxCellWrites = 0;
+  for (int i = 0; i < fake::EEPROM_SIZE; i++) {
+    if (fake::eepromCellWrites[i] > maxCellWrites) {
+      maxCellWrites = fake::eepromCellWrites[i];
+    }
+  }
+  Zone saved = zones[0];
+
+  // Reboot
+  zones[0] = factory;
+  loadSettings(&factory);
+  bool ok = zones[0].duration == saved.duration;
+
+  // Power cut halfway through the next save: the previous record survives
+  zones[0].duration = saved.duration % 120 + 1;
+  fake::eepromPowerCut = 2;
+  saveSettings();
+  fake::eepromPowerCut = -1;
+  loadSettings(&factory);
+  ok = ok && zones[0].duration == saved.duration;
+
+  printf("journal: %d saves, %.1f bytes/save, max %lu writes per cell (fixed addresses: %d) %s\n", saves,
+         (double)fake::eepromWrites / saves, maxCellWrites, saves, ok ? "yes" : "NO");
+  return ok;
+}
+
+// Open the menu two minutes before the 6:00 slot, sit in the duration editor
+// across it, then store the edit: the valve must still open on the minute and
+// the new duration must be saved
+static bool menuRuns() {
+  uint32_t slot = SIM_EPOCH + 6 * 3600UL;
+  fake::reset(slot - 120);
+  Zone factory = zoneFor(schedules[0], VALVE_PIN);
+  irrigationSetup(&factory, 1);
+
+  fake::pressButton(BUTTON_MENU, GESTURE_LONG);     // Open the menu
+  fake::pressButton(BUTTON_MENU, GESTURE_SHORT);    // Set Interval
+  fake::pressButton(BUTTON_MENU, GESTURE_SHORT);    // Set Duration
+  fake::pressButton(BUTTON_SELECT, GESTURE_LONG);   // Open the editor
+  fake::pressButton(BUTTON_SWITCH, GESTURE_SHORT);  // 31 minutes
+  uint32_t openedAt = 0;
+  while (halNow().unixtime < slot + 60) {
+    irrigationLoop();
+    if (fake::valveOn[VALVE_PIN] && openedAt == 0) {
+      openedAt = halNow().unixtime;
+    }
+    fake::advance(TICK_MS);
+  }
+  bool inEditor = currentMenu == SET_DURATION;
+
+  fake::pressButton(BUTTON_MENU, GESTURE_LONG);     // Store and go back
+  fake::pressButton(BUTTON_MENU, GESTURE_LONG);     // Close the menu
+  for (int i = 0; i < 10; i++) {
+    irrigationLoop();
+    fake::advance(TICK_MS);
+  }
+  Zone saved = zones[0];
+  loadSettings(&factory);
+
+  bool ok = inEditor && openedAt / 60 == slot / 60 && currentMenu == MAIN && saved.duration == 31 &&
+            zones[0].duration == 31;
+  printf("menu open across a slot: valve at +%lds, duration saved %d %s\n", (long)(openedAt - slot),
+         zones[0].duration, ok ? "yes" : "NO");
+  return ok;
+}
+
+// Poll the factory schedule at loop periods from 100 ms to 10 minutes: every
+// slot must fire exactly once, no later than one period after it begins
+static bool loopRateRuns() {
+  static const unsigned long periods[] = { 100, 1000, 59000, 90000, 600000 };
+  static Run expected[MAX_RUNS];
+  const Schedule &s = schedules[0];
+  uint32_t from = SIM_EPOCH + s.bootOffset;
+  uint32_t to = from + SIM_DAYS * 86400UL;
+  int expectedCount = referenceRuns(s, from, to, expected);
+  bool ok = true;
+
+  printf("slots fired once at loop periods of");
+  for (size_t p = 0; p < sizeof(periods) / sizeof(periods[0]); p++) {
+    fake::reset(from);
+    Zone zone = zoneFor(s, VALVE_PIN);
+    irrigationSetup(&zone, 1);
+
+    int count = 0;
+    bool valveWasOn = false;
+    uint32_t lastSlot = 0;
+    while (halNow().unixtime < to) {
+      irrigationLoop();
+      bool valveOn = fake::valveOn[VALVE_PIN];
+      if (valveOn && !valveWasOn) {
+        uint32_t slot = zoneRuns[0].lastSprayTime;
+        bool onTime = count < expectedCount && slot == expected[count].start &&
+                      halNow().unixtime - slot <= periods[p] / 1000 + 1;
+        ok = ok && onTime && slot != lastSlot;
+        lastSlot = slot;
+        count++;
+      }
+      valveWasOn = valveOn;
+      fake::advance(periods[p]);
+    }
+    ok = ok && count == expectedCount;
+    printf(" %lums", periods[p]);
+  }
+  printf(": %d runs each %s\n", expectedCount, ok ? "yes" : "NO");
+  return ok;
+}
+
+// Run the 6:00 slot, cut the power from 11:55 to 12:10 and check what each
+// catch-up policy does about the 12:00 slot it missed
+static bool catchUpRuns() {
+  static const char *const names[] = { "skip", "late", "shorten" };
+  static const int expectedMinutes[] = { 0, 30, 20 };
+  uint32_t day = SIM_EPOCH;
+  bool ok = true;
+
+  printf("catch-up after a power cut across 12:00:");
+  for (int policy = CATCH_UP_SKIP; policy <= CATCH_UP_SHORTEN; policy++) {
+    catchUpPolicy = (CatchUpPolicy)policy;
+    Zone factory = zoneFor(schedules[0], VALVE_PIN);
+    fake::reset(day + 6 * 3600UL - 60);
+    irrigationSetup(&factory, 1);
+    while (halNow().unixtime < day + 11 * 3600UL + 55 * 60) {
+      irrigationLoop();
+      fake::advance(TICK_MS);
+    }
+
+    fake::powerCycle(day + 12 * 3600UL + 10 * 60);
+    irrigationSetup(&factory, 1);
+    uint32_t openedAt = 0;
+    unsigned long openMillis = 0;
+    while (halNow().unixtime < day + 13 * 3600UL) {
+      irrigationLoop();
+      if (fake::valveOn[VALVE_PIN]) {
+        if (openedAt == 0) {
+          openedAt = halNow().unixtime;
+        }
+        openMillis += TICK_MS;
+      }
+      fake::advance(TICK_MS);
+    }
+
+    int minutes = (openMillis - 1000) / 60000UL;
+    if (openedAt == 0) {
+      minutes = 0;
+    }
+    ok = ok && minutes == expectedMinutes[policy] &&
+         (openedAt == 0 || openedAt - (day + 12 * 3600UL + 10 * 60) < 2);
+    printf(" %s %dmin", names[policy], minutes);
+  }
+  catchUpPolicy = CATCH_UP_SHORTEN;
+  printf(" %s\n", ok ? "yes" : "NO");
+  return ok;
+}
+
+// Eight zones: the first waters once a day at 6:00, the others every 30
+// minutes. Cut the power across the first zone's next 6:00 slot; after a day
+// of the others' runs it must still know its last run and catch up late
+static bool busyZonesCatchUpRuns() {
+  uint32_t day = SIM_EPOCH;
+  catchUpPolicy = CATCH_UP_LATE;
+  runPolicy = RUN_PARALLEL;
+  Zone table[MAX_ZONES];
+  for (uint8_t i = 0; i < MAX_ZONES; i++) {
+    Zone zone = { (uint8_t)(2 + i), 1, 1, 30, 6 * 60, 18 * 60 };
+    table[i] = zone;
+  }
+  table[0].interval = 1440;
+  table[0].duration = 30;
+  fake::reset(day + 6 * 3600UL - 60);
+  irrigationSetup(table, MAX_ZONES);
+  while (halNow().unixtime < day + 86400UL + 5 * 3600UL + 50 * 60) {
+    irrigationLoop();
+    fake::advance(TICK_MS);
+  }
+
+  uint32_t bootAt = day + 86400UL + 6 * 3600UL + 20 * 60;
+  fake::powerCycle(bootAt);
+  irrigationSetup(table, MAX_ZONES);
+  uint32_t openedAt = 0;
+  while (halNow().unixtime < bootAt + 10 * 60) {
+    irrigationLoop();
+    if (fake::valveOn[table[0].pin] && openedAt == 0) {
+      openedAt = halNow().unixtime;
+    }
+    fake::advance(TICK_MS);
+  }
+  catchUpPolicy = CATCH_UP_SHORTEN;
+  runPolicy = RUN_SEQUENTIAL;
+
+  bool ok = openedAt != 0 && openedAt - bootAt < 2;
+  printf("daily zone among %d busy ones, power cut across its slot: ", MAX_ZONES - 1);
+  if (openedAt != 0) {
+    printf("caught up at +%lds %s\n", (long)(openedAt - bootAt), ok ? "yes" : "NO");
+  } else {
+    printf("not caught up NO\n");
+  }
+  return ok;
+}
+
+// Run the 6:00 slot, then at 6:40 cut the interval from 6 hours to 30
+// minutes in the menu. The new schedule has a 6:30 slot the board never saw
+// due; closing the menu must not replay it, even when late runs catch up, and
+// the zone must next run at 7:00
+static bool intervalEditRuns() {
+  uint32_t day = SIM_EPOCH;
+  catchUpPolicy = CATCH_UP_LATE;
+  fake::reset(day + 6 * 3600UL - 60);
+  Zone factory = zoneFor(schedules[0], VALVE_PIN);
+  irrigationSetup(&factory, 1);
+  while (halNow().unixtime < day + 6 * 3600UL + 40 * 60) {
+    irrigationLoop();
+    fake::advance(TICK_MS);
+  }
+
+  // One gesture per loop pass: open the menu, go to Set Interval, open the
+  // editor, step down 11 times from 360 to 30 minutes, store, close
+  static const HalButtonEvent presses[] = {
+    { BUTTON_MENU, GESTURE_LONG }, { BUTTON_MENU, GESTURE_SHORT }, { BUTTON_SELECT, GESTURE_LONG },
+    { BUTTON_SELECT, GESTURE_SHORT }, { BUTTON_SELECT, GESTURE_SHORT }, { BUTTON_SELECT, GESTURE_SHORT },
+    { BUTTON_SELECT, GESTURE_SHORT }, { BUTTON_SELECT, GESTURE_SHORT }, { BUTTON_SELECT, GESTURE_SHORT },
+    { BUTTON_SELECT, GESTURE_SHORT }, { BUTTON_SELECT, GESTURE_SHORT }, { BUTTON_SELECT, GESTURE_SHORT },
+    { BUTTON_SELECT, GESTURE_SHORT }, { BUTTON_SELECT, GESTURE_SHORT },
+    { BUTTON_MENU, GESTURE_LONG }, { BUTTON_MENU, GESTURE_LONG },
+  };
+  const int pressCount = sizeof(presses) / sizeof(presses[0]);
+  int pressed = 0;
+  uint32_t openedAt = 0;
+  while (halNow().unixtime < day + 7 * 3600UL + 60) {
+    if (pressed < pressCount) {
+      fake::pressButton(presses[pressed].button, presses[pressed].gesture);
+      pressed++;
+    }
+    irrigationLoop();
+    if (fake::valveOn[VALVE_PIN] && openedAt == 0) {
+      openedAt = halNow().unixtime;
+    }
+    fake::advance(TICK_MS);
+  }
+  catchUpPolicy = CATCH_UP_SHORTEN;
+
+  bool ok = currentMenu == MAIN && zones[0].interval == 30 && openedAt / 60 == (day + 7 * 3600UL) / 60;
+  printf("interval edited across a slot: interval %d, next run at +%lds from 7:00 %s\n", zones[0].interval,
+         (long)(openedAt - (day + 7 * 3600UL)), ok ? "yes" : "NO");
+  return ok;
+}
+
+// Two zones, the first switched off across its 6:00 slot. At 6:40 the zone
+// editor switches it back on and moves to the second zone, staying in the
+// editor: the first zone must wait for its 12:00 slot, not fire the 6:00 one
+// it was off for, and the change must already be saved
+static bool zoneToggleRuns() {
+  uint32_t day = SIM_EPOCH;
+  fake::reset(day + 6 * 3600UL - 60);
+  Zone table[2] = { zoneFor(schedules[0], VALVE_PIN), zoneFor(schedules[0], VALVE_PIN - 1) };
+  table[0].enabled = 0;
+  irrigationSetup(table, 2);
+  while (halNow().unixtime < day + 6 * 3600UL + 40 * 60) {
+    irrigationLoop();
+    fake::advance(TICK_MS);
+  }
+
+  // Open the menu and the zone editor, switch zone 1 on, go to zone 2
+  static const HalButtonEvent presses[] = {
+    { BUTTON_MENU, GESTURE_LONG }, { BUTTON_SELECT, GESTURE_LONG },
+    { BUTTON_MENU, GESTURE_SHORT }, { BUTTON_SWITCH, GESTURE_SHORT },
+  };
+  const int pressCount = sizeof(presses) / sizeof(presses[0]);
+  int pressed = 0;
+  uint32_t openedAt = 0;
+  while (halNow().unixtime < day + 12 * 3600UL + 60) {
+    if (pressed < pressCount) {
+      fake::pressButton(presses[pressed].button, presses[pressed].gesture);
+      pressed++;
+    }
+    irrigationLoop();
+    if (fake::valveOn[VALVE_PIN] && openedAt == 0) {
+      openedAt = halNow().unixtime;
+    }
+    fake::advance(TICK_MS);
+  }
+  bool inEditor = currentMenu == SET_ZONE && editZone == 1;
+  Zone saved[2] = { zones[0], zones[1] };
+  loadSettings(table);
+
+  fake::pressButton(BUTTON_MENU, GESTURE_LONG);  // Back to the list
+  fake::pressButton(BUTTON_MENU, GESTURE_LONG);  // Close the menu
+  for (int i = 0; i < 10; i++) {
+    irrigationLoop();
+    fake::advance(TICK_MS);
+  }
+  editZone = 0;
+
+  bool ok = inEditor && saved[0].enabled && zones[0].enabled && currentMenu == MAIN && openedAt / 60 == (day + 12 * 3600UL) / 60;
+  printf("zone switched on in the editor after its slot: next run at %s%lds from 12:00, saved %s %s\n",
+         openedAt >= day + 12 * 3600UL ? "+" : "", (long)(openedAt - (day + 12 * 3600UL)),
+         zones[0].enabled ? "on" : "off", ok ? "yes" : "NO");
+  return ok;
+}
+
+// Bus cost of one loop pass: the frame it flushes, decoded by the virtual panel
+struct LcdPass {
+  unsigned long transactions;
+  unsigned long bytes;
+  unsigned long enablePulses;
+};
+
+static LcdPass lcdPass() {
+  LcdBusStats before = fake::panel.stats();
+  irrigationLoop();
+  const LcdBusStats &after = fake::panel.stats();
+  LcdPass pass = { after.transactions - before.transactions, after.bytes - before.bytes,
+                   after.enablePulses - before.enablePulses };
+  return pass;
+}
+
+static bool showing(const char *top, const char *bottom) {
+  return strcmp(fake::panel.row(0), top) == 0 && strcmp(fake::panel.row(1), bottom) == 0;
+}
+
+// Draw the main screen and the first menu screens on the virtual panel and
+// check what the glass shows and what each frame cost on the bus: a full
+// redraw latches two nibbles per cell and cursor command, an unchanged screen
+// sends nothing, and a new minute resends one cell
+static bool lcdRuns() {
+  fake::reset(SIM_EPOCH + 8 * 3600UL + 2);
+  Zone factory = zoneFor(schedules[0], VALVE_PIN);
+  LcdBusStats before = fake::panel.stats();
+  irrigationSetup(&factory, 1);
+  const LcdBusStats &after = fake::panel.stats();
+  LcdPass full = { after.transactions - before.transactions, after.bytes - before.bytes,
+                   after.enablePulses - before.enablePulses };
+  bool ok = fake::panel.displayOn() && fake::panel.backlight() &&
+            showing("T:08:00 ST:6:00 ", "6h-30m ET:18:00 ") &&
+            full.enablePulses == 2 * (LCD_FRAME_ROWS + LCD_FRAME_ROWS * LCD_FRAME_COLS);
+
+  LcdPass same = lcdPass();
+  ok = ok && same.transactions == 0;
+
+  fake::advance(60000);
+  LcdPass minute = lcdPass();
+  ok = ok && showing("T:08:01 ST:6:00 ", "6h-30m ET:18:00 ") && minute.transactions == 1 &&
+       minute.enablePulses == 4;
+
+  fake::pressButton(BUTTON_MENU, GESTURE_LONG);
+  LcdPass list = lcdPass();
+  ok = ok && showing("> Set Zone      ", "                ");
+
+  fake::pressButton(BUTTON_SELECT, GESTURE_LONG);
+  LcdPass editor = lcdPass();
+  ok = ok && showing("Set Zone:       ", "Zone 1 on       ");
+
+  fake::pressButton(BUTTON_MENU, GESTURE_SHORT);
+  LcdPass toggle = lcdPass();
+  ok = ok && showing("Set Zone:       ", "Zone 1 off      ");
+
+  printf("lcd bytes/transactions per frame: full %lu/%lu, unchanged %lu/%lu, minute %lu/%lu, "
+         "menu %lu/%lu, editor %lu/%lu, toggle %lu/%lu %s\n",
+         full.bytes, full.transactions, same.bytes, same.transactions, minute.bytes, minute.transactions,
+         list.bytes, list.transactions, editor.bytes, editor.transactions, toggle.bytes, toggle.transactions,
+         ok ? "yes" : "NO");
+  if (!ok) {
+    printf("  screen: [%s]", fake::panel.row(0));
+    printf(" [%s]\n", fake::panel.row(1));
+  }
+  return ok;
+}
+
+// Press-to-screen latency on a board that does not sleep: each gesture is
+// handed over partway through the pause after a pass, and must be on the
+// glass in the pass that follows at once, not after the rest of the pause.
+// Host time inside a pass is not counted; the fake clock only moves in idle().
+static bool pressLatencyRuns() {
+  fake::reset(SIM_EPOCH + 8 * 3600UL + 2);
+  Zone factory = zoneFor(schedules[0], VALVE_PIN);
+  irrigationSetup(&factory, 1);
+
+  // Open the menu, step through two items, close it; each one redraws
+  static const HalButtonEvent presses[] = {
+    { BUTTON_MENU, GESTURE_LONG }, { BUTTON_MENU, GESTURE_SHORT },
+    { BUTTON_MENU, GESTURE_SHORT }, { BUTTON_MENU, GESTURE_LONG },
+  };
+  static const unsigned long readyAfter[] = { 1, 10, 50, 99 };  // ms into the pause
+  const int pressCount = sizeof(presses) / sizeof(presses[0]);
+  unsigned long latency[pressCount];
+  bool ok = true;
+  for (int i = 0; i < pressCount; i++) {
+    irrigationLoop();
+    unsigned long readyAt = fake::millis + readyAfter[i];
+    fake::pressButtonAt(readyAt, presses[i].button, presses[i].gesture);
+    unsigned long before = fake::panel.stats().transactions;
+    unsigned long drawnAt = 0;
+    for (int pass = 0; pass < 5 && drawnAt == 0; pass++) {
+      fake::idle();
+      irrigationLoop();
+      if (fake::panel.stats().transactions != before) {
+        drawnAt = fake::millis;
+      }
+    }
+    latency[i] = drawnAt >= readyAt ? drawnAt - readyAt : 0;
+    ok = ok && drawnAt != 0 && latency[i] < 10;
+  }
+  ok = ok && currentMenu == MAIN;
+
+  printf("press to screen, gesture ready 1/10/50/99 ms into the pause: %lu/%lu/%lu/%lu ms %s\n", latency[0],
+         latency[1], latency[2], latency[3], ok ? "yes" : "NO");
+  return ok;
+}
+
+int main() {
+  static Run expected[MAX_RUNS];
+  static Run actual[MAX_RUNS];
+  int failures = 0;
+  unsigned long totalTicks = 0;
+  double totalWall = 0;
+
+  printf("%-34s %5s %5s %12s %14s\n", "schedule", "runs", "ok", "ticks/s", "max latency");
+  for (size_t i = 0; i < sizeof(schedules) / sizeof(schedules[0]); i++) {
+    const Schedule &s = schedules[i];
+    uint32_t from = SIM_EPOCH + s.bootOffset;
+    uint32_t to = from + SIM_DAYS * 86400UL;
+
+    int expectedCount = referenceRuns(s, from, to, expected);
+    unsigned long ticks;
+    unsigned long maxLatencyMs;
+    double wallStart = wallSeconds();
+    int actualCount = simulatedRuns(s, from, to, actual, &ticks, &maxLatencyMs);
+    double wall = wallSeconds() - wallStart;
+    totalTicks += ticks;
+    totalWall += wall;
+
+    // Runs still open at the end of the simulation are not compared
+    if (actualCount < expectedCount && expectedCount - actualCount == 1 && expected[expectedCount - 1].start + expected[expectedCount - 1].minutes * 60UL >= to - 2) {
+      expectedCount--;
+    }
+
+    bool ok = actualCount == expectedCount;
+    for (int r = 0; ok && r < actualCount; r++) {
+      ok = actual[r].start / 60 == expected[r].start / 60 && actual[r].minutes == expected[r].minutes;
+      if (!ok) {
+        printf("  run %d: expected %lu+%dmin, got %lu+%dmin\n", r, (unsigned long)expected[r].start,
+               expected[r].minutes, (unsigned long)actual[r].start, actual[r].minutes);
+      }
+    }
+    if (!ok) {
+      failures++;
+    }
+
+    char name[40];
+    snprintf(name, sizeof(name), "%dm/%dm %02d:%02d-%02d:%02d", s.sprayMinutes, s.sprayDuration,
+             s.startHour, s.startMinute, s.endHour, s.endMinute);
+    printf("%-34s %5d %5s %12.0f %11lu ms\n", name, actualCount, ok ? "yes" : "NO", ticks / wall, maxLatencyMs);
+  }
+
+  // Every zone on the factory schedule, both run policies
+  for (int policy = RUN_SEQUENTIAL; policy <= RUN_PARALLEL; policy++) {
+    unsigned long ticks;
+    double wall;
+    if (!multiZoneRuns(schedules[0], (RunPolicy)policy, &ticks, &wall)) {
+      failures++;
+    }
+    totalTicks += ticks;
+    totalWall += wall;
+  }
+
+  printf("\n%lu ticks in %.3f s: %.0f ns/tick\n", totalTicks, totalWall, totalWall * 1e9 / totalTicks);
+  printf("zone table: %u zones, %u bytes RAM, %d bytes per journal record\n", (unsigned)MAX_ZONES,
+         (unsigned)(sizeof(zones) + sizeof(zoneRuns)), JOURNAL_RECORD_SIZE);
+
+  if (!journalRuns(1000)) {
+    failures++;
+  }
+  if (!menuRuns()) {
+    failures++;
+  }
+  if (!catchUpRuns()) {
+    failures++;
+  }
+  if (!busyZonesCatchUpRuns()) {
+    failures++;
+  }
+  if (!intervalEditRuns()) {
+    failures++;
+  }
+  if (!zoneToggleRuns()) {
+    failures++;
+  }
+  if (!loopRateRuns()) {
+    failures++;
+  }
+  if (!lcdRuns()) {
+    failures++;
+  }
+  if (!pressLatencyRuns()) {
+    failures++;
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+// Host-side schedule simulator: runs the irrigation core against the fake
+// HAL over a whole year (or any number of days) and prints every run it
+// waters, so a schedule change can be checked before it goes to a field.
+//
+//   pio run -e simulator && .pio/build/simulator/program [options] schedule...
+//
+// Each schedule is one zone, as interval/duration/HH:MM-HH:MM in minutes,
+// e.g. 360/30/06:00-18:00 for the factory setting. Options:
+//
+//   -d days   Days to simulate (365)
+//   -p        Open every due valve at once (RUN_PARALLEL)
+//   -q        Print only the totals
+//
+// The clock skips ahead instead of ticking, from one spray start or run
+// engine event to the next, so a year takes a few thousand loop passes per
+// zone. The events mirror the engine's timing (a 1 s alarm pulse, then the
+// run), so the times printed are the ones the board would show.
+//
+// Output, one line per run: zone, valve open and close times, and the run
+// length after clipping to the spray window.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../native/FakeHal.h"
+
+const uint32_t SIM_EPOCH = 1735689600UL;  // 2025-01-01 00:00:00
+
+static double wallSeconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void formatTime(uint32_t unixtime, char *buffer, size_t size) {
+  time_t t = unixtime;
+  struct tm tm;
+  gmtime_r(&t, &tm);
+  strftime(buffer, size, "%Y-%m-%d %H:%M:%S", &tm);
+}
+
+static bool parseSchedule(const char *text, uint8_t pin, Zone &zone) {
+  int interval, duration, startHour, startMinute, endHour, endMinute;
+  if (sscanf(text, "%d/%d/%d:%d-%d:%d", &interval, &duration, &startHour, &startMinute, &endHour, &endMinute) != 6 ||
+      interval < 30 || interval > 1440 || duration < 1 || duration > 120 || startHour < 0 || startHour > 23 ||
+      startMinute < 0 || startMinute > 59 || endHour < 0 || endHour > 23 || endMinute < 0 || endMinute > 59) {
+    return false;
+  }
+  Zone parsed = { pin, 1, (uint8_t)duration, (uint16_t)interval, (uint16_t)(startHour * 60 + startMinute),
+                  (uint16_t)(endHour * 60 + endMinute) };
+  zone = parsed;
+  return true;
+}
+
+int main(int argc, char **argv) {
+  int days = 365;
+  bool quiet = false;
+  int option;
+  while ((option = getopt(argc, argv, "d:pq")) != -1) {
+    switch (option) {
+      case 'd': days = atoi(optarg); break;
+      case 'p': runPolicy = RUN_PARALLEL; break;
+      case 'q': quiet = true; break;
+      default:
+        fprintf(stderr, "usage: %s [-d days] [-p] [-q] interval/duration/HH:MM-HH:MM...\n", argv[0]);
+        return 2;
+    }
+  }
+
+  Zone table[MAX_ZONES];
+  uint8_t count = 0;
+  for (int i = optind; i < argc; i++) {
+    if (count == MAX_ZONES || !parseSchedule(argv[i], 2 + count, table[count])) {
+      fprintf(stderr, "bad schedule (or more than %d): %s\n", MAX_ZONES, argv[i]);
+      return 2;
+    }
+    count++;
+  }
+  if (count == 0) {
+    parseSchedule("360/30/06:00-18:00", 2, table[0]);
+    count = 1;
+  }
+
+  uint32_t to = SIM_EPOCH + days * 86400UL;
+  fake::reset(SIM_EPOCH);
+  irrigationSetup(table, count);
+
+  uint32_t openedAt[MAX_ZONES] = { 0 };
+  unsigned long runs[MAX_ZONES] = { 0 };
+  unsigned long wateredMinutes[MAX_ZONES] = { 0 };
+  unsigned long passes = 0;
+  double wallStart = wallSeconds();
+
+  if (!quiet) {
+    printf("%-4s %-19s  %-19s  %s\n", "zone", "open", "close", "min");
+  }
+  while (halNow().unixtime < to) {
+    irrigationLoop();
+    passes++;
+
+    uint32_t now = halNow().unixtime;
+    for (uint8_t i = 0; i < count; i++) {
+      bool on = fake::valveOn[table[i].pin];
+      if (on && openedAt[i] == 0) {
+        openedAt[i] = now;
+      } else if (!on && openedAt[i] != 0) {
+        runs[i]++;
+        wateredMinutes[i] += zoneRuns[i].runMinutes;
+        if (!quiet) {
+          char opened[20], closed[20];
+          formatTime(openedAt[i], opened, sizeof(opened));
+          formatTime(now, closed, sizeof(closed));
+          printf("Z%-3d %s  %s  %3d\n", i + 1, opened, closed, zoneRuns[i].runMinutes);
+        }
+        openedAt[i] = 0;
+      }
+    }
+
+    unsigned long step = fake::untilNextEvent();
+    if (step == 0) {
+      break;  // Every zone disabled: nothing will ever run
+    }
+    fake::advance(step);
+  }
+  double wall = wallSeconds() - wallStart;
+
+  printf("\n");
+  for (uint8_t i = 0; i < count; i++) {
+    printf("Z%d %u/%u/%02u:%02u-%02u:%02u: %lu runs, %lu minutes watered\n", i + 1, table[i].interval,
+           table[i].duration, table[i].start / 60, table[i].start % 60, table[i].end / 60, table[i].end % 60, runs[i],
+           wateredMinutes[i]);
+  }
+  printf("%d days in %.3f s, %lu loop passes: %.0f simulated minutes/s\n", days, wall, passes,
+         days * 1440.0 / wall);
+  return 0;
+}
@@ -0,0 +1,293 @@
+// Exhaustive check of the scheduler over the whole settings space the menu
+// can reach: every interval (30..1440 in steps of 30), duration (1..120),
+// start and end minute (0..1439). Each configuration boots the core at
+// midnight, runs two days of checkIrrigation()/updateIrrigation() on the
+// fake HAL, skipping the clock from event to event, and checks every run:
+//
+//   window     the run started inside the spray window, before its closing
+//              minute
+//   slot       it started on a slot (start + k * interval), within a minute;
+//              the valve opens on the pass after the one that queued the run
+//   clip       it ended by the window's end. Runs are clipped in whole minutes
+//              counted from their slot, so one that starts late in its minute
+//              may end up to that much past the end
+//   duration   it lasted 1..duration minutes
+//   overlap    it started after the previous run ended
+//   missed     every slot with the valve closed started a run
+//
+//   pio run -e sweep && .pio/build/sweep/program [-j workers] [-s stride] [-i interval]
+//
+// -s n checks every n-th start and end minute only, -i one interval only.
+// The space is cut into one chunk per interval and duration. The core keeps
+// its state in globals, as the firmware does, so the workers are forked
+// processes rather than threads; each takes the next chunk from a counter in
+// shared memory when it finishes one, so fast and slow chunks even out.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "../native/FakeHal.h"
+
+const uint32_t SIM_EPOCH = 1735689600UL;  // 2025-01-01 00:00:00
+const uint32_t SIM_END = SIM_EPOCH + 2 * 86400UL;
+const uint8_t VALVE_PIN = 2;
+const int INTERVALS = 48;
+const int DURATIONS = 120;
+const int MAX_RUNS = 128;
+const int MAX_EXAMPLES = 16;
+const int MAX_WORKERS = 256;
+
+enum Invariant { WINDOW, SLOT, CLIP, DURATION, OVERLAP, MISSED, INVARIANTS };
+static const char *const invariantNames[] = { "window", "slot", "clip", "duration", "overlap", "missed" };
+
+struct Violation {
+  Zone zone;
+  uint8_t invariant;
+  uint32_t at;  // Valve open time, or the slot that was missed
+};
+
+// One per worker, in shared memory
+struct WorkerResult {
+  unsigned long long configurations;
+  unsigned long long runs;
+  unsigned long long violations[INVARIANTS];
+  int examples;
+  Violation example[MAX_EXAMPLES];
+};
+
+struct Shared {
+  int nextChunk;
+  WorkerResult workers[MAX_WORKERS];
+};
+
+struct Run {
+  uint32_t open;
+  uint32_t close;
+  uint32_t slot;
+  int minutes;
+};
+
+static double wallSeconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(WorkerResult &result, const Zone &zone, Invariant invariant, uint32_t at) {
+  result.violations[invariant]++;
+  if (result.examples < MAX_EXAMPLES) {
+    Violation &example = result.example[result.examples++];
+    example.zone = zone;
+    example.invariant = invariant;
+    example.at = at;
+  }
+}
+
+// Minutes from the start of the window holding t, and the window's length
+static int minutesIntoWindow(const Zone &zone, uint32_t t) {
+  return ((t / 60) % (24 * 60) - zone.start + 24 * 60) % (24 * 60);
+}
+
+static int windowLength(const Zone &zone) {
+  int minutes = zone.end - zone.start;
+  return minutes > 0 ? minutes : minutes + 24 * 60;
+}
+
+// Run two days of one configuration and record what the valve did
+static int simulate(const Zone &zone, Run *runs) {
+  fake::millis = 0;
+  fake::bootUnixtime = SIM_EPOCH;
+  fake::valveOn[VALVE_PIN] = false;
+  zones[0] = zone;
+  memset(zoneRuns, 0, sizeof(zoneRuns[0]));
+  currentTime = halNow();
+  calculateNextSprayTimes();
+
+  int count = 0;
+  bool wasOn = false;
+  while (currentTime.unixtime < SIM_END) {
+    checkIrrigation();
+    updateIrrigation();
+
+    bool on = fake::valveOn[VALVE_PIN];
+    if (on && !wasOn && count < MAX_RUNS) {
+      runs[count].open = currentTime.unixtime;
+      runs[count].slot = zoneRuns[0].lastSprayTime;
+      runs[count].minutes = zoneRuns[0].runMinutes;
+      runs[count].close = 0;
+    } else if (!on && wasOn && count < MAX_RUNS) {
+      runs[count++].close = currentTime.unixtime;
+    }
+    wasOn = on;
+
+    fake::advance(fake::untilNextEvent());
+    currentTime = halNow();
+  }
+  // A run still open at the end counts as ending there
+  if (wasOn && count < MAX_RUNS) {
+    runs[count++].close = SIM_END;
+  }
+  return count;
+}
+
+static void checkConfiguration(const Zone &zone, WorkerResult &result) {
+  static Run runs[MAX_RUNS];
+  int count = simulate(zone, runs);
+  int window = windowLength(zone);
+  result.configurations++;
+  result.runs += count;
+
+  for (int r = 0; r < count; r++) {
+    const Run &run = runs[r];
+    int into = minutesIntoWindow(zone, run.open);
+    if (into >= window) {
+      report(result, zone, WINDOW, run.open);
+    }
+    if (run.open - run.slot > 60 || minutesIntoWindow(zone, run.slot) % zone.interval != 0) {
+      report(result, zone, SLOT, run.open);
+    }
+    // Valve open = 1 s alarm pulse + the run, closed on the next loop pass
+    uint32_t windowEnd = run.slot + (window - minutesIntoWindow(zone, run.slot)) * 60UL;
+    if (run.close > windowEnd + 60 + 2 && run.close != SIM_END) {
+      report(result, zone, CLIP, run.open);
+    }
+    if (run.minutes < 1 || run.minutes > zone.duration) {
+      report(result, zone, DURATION, run.open);
+    }
+    if (r > 0 && run.open < runs[r - 1].close) {
+      report(result, zone, OVERLAP, run.open);
+    }
+  }
+
+  // Every slot of the windows that opened from the day before, up to the end
+  uint32_t firstWindow = SIM_EPOCH - 86400UL + zone.start * 60UL;
+  int slots = (window - 1) / zone.interval + 1;
+  int r = 0;
+  for (uint32_t windowStart = firstWindow; windowStart < SIM_END; windowStart += 86400UL) {
+    for (int k = 0; k < slots; k++) {
+      uint32_t slot = windowStart + k * (zone.interval * 60UL);
+      if (slot < SIM_EPOCH || slot >= SIM_END) {
+        continue;
+      }
+      while (r < count && runs[r].close <= slot) {
+        r++;
+      }
+      // Inside a run (skipped by design), or the run that started here
+      if (r < count && runs[r].open <= slot) {
+        continue;
+      }
+      if (!(r < count && runs[r].slot == slot)) {
+        report(result, zone, MISSED, slot);
+      }
+    }
+  }
+}
+
+static void work(Shared *shared, int worker, int chunks, int interval, int stride) {
+  WorkerResult &result = shared->workers[worker];
+  zoneCount = 1;
+  for (;;) {
+    int chunk = __atomic_fetch_add(&shared->nextChunk, 1, __ATOMIC_RELAXED);
+    if (chunk >= chunks) {
+      return;
+    }
+    Zone zone = { VALVE_PIN, 1, 0, 0, 0, 0 };
+    zone.interval = interval > 0 ? interval : 30 * (1 + chunk / DURATIONS);
+    zone.duration = 1 + chunk % DURATIONS;
+    for (int start = 0; start < 24 * 60; start += stride) {
+      for (int end = 0; end < 24 * 60; end += stride) {
+        zone.start = start;
+        zone.end = end;
+        checkConfiguration(zone, result);
+      }
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  int workers = sysconf(_SC_NPROCESSORS_ONLN);
+  int stride = 1;
+  int interval = 0;
+  int option;
+  while ((option = getopt(argc, argv, "j:s:i:")) != -1) {
+    switch (option) {
+      case 'j': workers = atoi(optarg); break;
+      case 's': stride = atoi(optarg); break;
+      case 'i': interval = atoi(optarg); break;
+      default:
+        fprintf(stderr, "usage: %s [-j workers] [-s stride] [-i interval]\n", argv[0]);
+        return 2;
+    }
+  }
+  if (workers < 1 || workers > MAX_WORKERS || stride < 1 || (interval != 0 && (interval < 30 || interval > 1440))) {
+    fprintf(stderr, "workers 1..%d, stride >= 1, interval 30..1440\n", MAX_WORKERS);
+    return 2;
+  }
+  int chunks = (interval > 0 ? 1 : INTERVALS) * DURATIONS;
+
+  Shared *shared = (Shared *)mmap(0, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (shared == MAP_FAILED) {
+    perror("mmap");
+    return 1;
+  }
+  memset(shared, 0, sizeof(Shared));
+
+  double wallStart = wallSeconds();
+  for (int w = 0; w < workers; w++) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      work(shared, w, chunks, interval, stride);
+      _exit(0);
+    } else if (pid < 0) {
+      perror("fork");
+      return 1;
+    }
+  }
+  int failedWorkers = 0;
+  int status;
+  while (wait(&status) > 0) {
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      failedWorkers++;
+    }
+  }
+  double wall = wallSeconds() - wallStart;
+
+  WorkerResult total;
+  memset(&total, 0, sizeof(total));
+  for (int w = 0; w < workers; w++) {
+    const WorkerResult &result = shared->workers[w];
+    total.configurations += result.configurations;
+    total.runs += result.runs;
+    for (int i = 0; i < INVARIANTS; i++) {
+      total.violations[i] += result.violations[i];
+    }
+    for (int e = 0; e < result.examples && total.examples < MAX_EXAMPLES; e++) {
+      total.example[total.examples++] = result.example[e];
+    }
+  }
+
+  unsigned long long violations = 0;
+  printf("%llu configurations, %llu runs, %d workers, %.1f s: %.0f configurations/s\n", total.configurations,
+         total.runs, workers, wall, total.configurations / wall);
+  for (int i = 0; i < INVARIANTS; i++) {
+    printf("  %-9s %llu violations\n", invariantNames[i], total.violations[i]);
+    violations += total.violations[i];
+  }
+  for (int e = 0; e < total.examples; e++) {
+    const Violation &v = total.example[e];
+    time_t at = v.at;
+    struct tm tm;
+    gmtime_r(&at, &tm);
+    printf("  e.g. %s: %u/%u/%02u:%02u-%02u:%02u at day %d %02d:%02d\n", invariantNames[v.invariant], v.zone.interval,
+           v.zone.duration, v.zone.start / 60, v.zone.start % 60, v.zone.end / 60, v.zone.end % 60,
+           (int)((v.at - SIM_EPOCH) / 86400), tm.tm_hour, tm.tm_min);
+  }
+  if (failedWorkers > 0) {
+    printf("%d workers failed\n", failedWorkers);
+  }
+  return violations == 0 && failedWorkers == 0 ? 0 : 1;
+}
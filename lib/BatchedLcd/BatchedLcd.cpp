@@ -0,0 +1,88 @@
+#include "BatchedLcd.h"
+
+// Expander bytes needed per character: En high + En low for each nibble
+#define LCD_BATCH_CHAR_BYTES 4
+
+BatchedLcd::BatchedLcd(uint8_t lcd_Addr, uint8_t lcd_cols, uint8_t lcd_rows)
+  : LiquidCrystal_I2C(lcd_Addr, lcd_cols, lcd_rows),
+    _addr(lcd_Addr), _rows(lcd_rows), _backlightBit(LCD_NOBACKLIGHT), _mode(0), _queued(0), _current(0) {
+  for (uint8_t i = 0; i < LCD_BATCH_SLOTS; i++) {
+    _batches[i].transaction.status = TWI_OK;
+  }
+}
+
+void BatchedLcd::backlight() {
+  _backlightBit = LCD_BACKLIGHT;
+  LiquidCrystal_I2C::backlight();
+}
+
+void BatchedLcd::noBacklight() {
+  _backlightBit = LCD_NOBACKLIGHT;
+  LiquidCrystal_I2C::noBacklight();
+}
+
+size_t BatchedLcd::write(uint8_t value) {
+  queue(value, Rs);
+  flushQueue();
+  return 1;
+}
+
+size_t BatchedLcd::write(const uint8_t *buffer, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    queue(buffer[i], Rs);
+  }
+  flushQueue();
+  return size;
+}
+
+void BatchedLcd::writeAt(uint8_t col, uint8_t row, const uint8_t *buffer, size_t size) {
+  static const uint8_t rowOffsets[] = { 0x00, 0x40, 0x14, 0x54 };
+  if (row >= _rows) {
+    row = _rows - 1;
+  }
+  queue(LCD_SETDDRAMADDR | (col + rowOffsets[row]), 0);
+  write(buffer, size);
+}
+
+// Append one command (mode 0) or data (mode Rs) byte to the open transaction
+void BatchedLcd::queue(uint8_t value, uint8_t mode) {
+  uint8_t hi = (value & 0xF0) | mode | _backlightBit;
+  uint8_t lo = ((value << 4) & 0xF0) | mode | _backlightBit;
+  bool setup = _queued == 0 || mode != _mode;
+
+  // Keep each character inside a single transaction
+  if (_queued + LCD_BATCH_CHAR_BYTES + (setup ? 1 : 0) > LCD_BATCH_MAX) {
+    flushQueue();
+    setup = true;
+  }
+  Batch &batch = _batches[_current];
+  if (_queued == 0) {
+    // The slot's previous batch may still be on the bus
+    twiQueue.wait(batch.transaction);
+  }
+
+  if (setup) {
+    batch.data[_queued++] = hi;
+  }
+  batch.data[_queued++] = hi | En;
+  batch.data[_queued++] = hi;
+  batch.data[_queued++] = lo | En;
+  batch.data[_queued++] = lo;
+  _mode = mode;
+}
+
+// Hand the open batch to the TWI queue and move on to the next slot
+void BatchedLcd::flushQueue() {
+  if (_queued > 0) {
+    Batch &batch = _batches[_current];
+    batch.transaction.address = _addr;
+    batch.transaction.writeData = batch.data;
+    batch.transaction.writeLength = _queued;
+    batch.transaction.readData = 0;
+    batch.transaction.readLength = 0;
+    batch.transaction.done = 0;
+    twiQueue.submit(batch.transaction);
+    _current = (_current + 1) % LCD_BATCH_SLOTS;
+    _queued = 0;
+  }
+}
@@ -0,0 +1,76 @@
+#ifndef BatchedLcd_h
+#define BatchedLcd_h
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <LiquidCrystal_I2C.h>
+#include <LcdSink.h>
+#include <TwiQueue.h>
+
+// Largest TWI transaction we will build
+#ifndef LCD_BATCH_MAX
+#define LCD_BATCH_MAX 32
+#endif
+
+// Transactions that can be on their way to the panel at once; each costs
+// LCD_BATCH_MAX plus a dozen bytes of RAM
+#ifndef LCD_BATCH_SLOTS
+#define LCD_BATCH_SLOTS 2
+#endif
+
+// LiquidCrystal_I2C with a batched data path.
+//
+// The stock library sends every nibble as three separate Wire transactions
+// (data, En high, En low) with delayMicroseconds() after each, so one
+// character costs six transactions and ~100 us of busy-waiting. BatchedLcd
+// encodes each character as consecutive PCF8574 output bytes instead:
+//
+//   [setup] hi|En, hi, lo|En, lo
+//
+// and packs as many characters as fit into one TWI transaction. The HD44780
+// latches on the falling edge of En, so hi/lo hold the data across that edge;
+// the setup byte (En low) is only sent when RS may have changed, i.e. at the
+// start of a transaction or when switching between command and data. At
+// 100-400 kHz each expander byte takes 22-90 us on the bus, which already
+// covers the En pulse width and the 37 us execution time, so no delays are
+// needed.
+//
+// Batches are handed to the TWI queue and sent from the TWI interrupt, so
+// writeAt() returns as soon as the bytes are queued; it only waits when all
+// LCD_BATCH_SLOTS are still on the bus. Commands that take longer than 37 us
+// (clear, home) still go through the stock, unbatched Wire path, which the
+// queue keeps in order with the batches. The backlight must be switched through this class
+// so the batched bytes carry the right backlight bit.
+class BatchedLcd : public LiquidCrystal_I2C, public LcdSink {
+public:
+  BatchedLcd(uint8_t lcd_Addr, uint8_t lcd_cols, uint8_t lcd_rows);
+
+  void backlight();
+  void noBacklight();
+
+  virtual size_t write(uint8_t value);
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  using Print::write;
+
+  // Position the cursor and write a run of characters as one batch
+  virtual void writeAt(uint8_t col, uint8_t row, const uint8_t *buffer, size_t size);
+
+private:
+  void queue(uint8_t value, uint8_t mode);
+  void flushQueue();
+
+  struct Batch {
+    TwiTransaction transaction;
+    uint8_t data[LCD_BATCH_MAX];
+  };
+
+  uint8_t _addr;
+  uint8_t _rows;
+  uint8_t _backlightBit;
+  uint8_t _mode;      // RS state of the last queued byte
+  uint8_t _queued;    // Bytes in the open batch
+  Batch _batches[LCD_BATCH_SLOTS];
+  uint8_t _current;   // Batch being filled
+};
+
+#endif
@@ -0,0 +1,64 @@
+// Compares the stock LiquidCrystal_I2C per-character path against BatchedLcd
+// by timing full 16-character row writes on the same display, until the last
+// byte is off the bus, and counting the TWI transactions each row took.
+// Needs -D TWI_QUEUE_PROFILE in build_flags for the counts (TwiStats).
+
+#include <Wire.h>
+#include <LiquidCrystal_I2C.h>
+#include <BatchedLcd.h>
+#include <TwiQueue.h>
+
+#ifndef TWI_QUEUE_PROFILE
+#error "Build with -D TWI_QUEUE_PROFILE: the transaction counts come from TwiStats"
+#endif
+
+const uint8_t LCD_ADDRESS = 0x27;
+const int ROUNDS = 50;
+const char row[] = "0123456789ABCDEF";
+
+LiquidCrystal_I2C stock(LCD_ADDRESS, 16, 2);
+BatchedLcd batched(LCD_ADDRESS, 16, 2);
+
+uint32_t transactionsSoFar() {
+  TwiStats stats;
+  twiQueue.stats(stats);
+  return stats.transactions;
+}
+
+// Write the row ROUNDS times; batches are still on the bus when writeAt()
+// returns, so the clock stops only once the queue has drained
+template <class Write> void measure(const char *name, Write write) {
+  twiQueue.flush();
+  uint32_t transactions = transactionsSoFar();
+  unsigned long start = micros();
+  for (int i = 0; i < ROUNDS; i++) {
+    write();
+  }
+  twiQueue.flush();
+  unsigned long us = (micros() - start) / ROUNDS;
+  transactions = transactionsSoFar() - transactions;
+
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print(us);
+  Serial.print(" us/row, ");
+  Serial.print((float)transactions / ROUNDS, 1);
+  Serial.println(" I2C transactions/row");
+}
+
+void setup() {
+  Serial.begin(9600);
+
+  stock.init();
+  stock.backlight();
+  batched.backlight();
+
+  measure("stock  ", []() {
+    stock.setCursor(0, 0);
+    stock.print(row);
+  });
+  measure("batched", []() { batched.writeAt(0, 0, (const uint8_t *)row, 16); });
+}
+
+void loop() {
+}
@@ -0,0 +1,44 @@
+#ifndef BoardConfig_h
+#define BoardConfig_h
+
+#include <FastPin.h>
+#include "BoardZones.h"
+
+// Board profiles, picked at build time with -D BOARD_NOEL or -D BOARD_JUDE
+// (see the platformio.ini of each firmware). A profile sets the pin map and
+// the optional hardware the shared firmware (lib/IrrigationBoard) may use.
+// The pins are compile-time constants, so the FastPin types below turn every
+// alarm and relay write into a single instruction; the buttons are sampled by
+// lib/Buttons, a port at a time. The number of valves,
+// which sizes the zone table, is in BoardZones.h.
+//
+//   BOARD_HAS_RTC_INT  DS3231 INT/SQW wired to RTC_INT_PIN; needed by LOW_POWER_SLEEP
+#if defined(BOARD_NOEL)
+// ekp_irrigation_engr_noel, Nano ATmega168
+const uint8_t ALARM_PIN = 13;
+const uint8_t MENU_PIN = 8;        // Button for menu navigation and selection
+const uint8_t SELECT_PIN = 6;      // Button for decreasing values
+const uint8_t IRRIGATION_PIN = 12;
+const uint8_t SWITCH_PIN = 5;      // Button for increasing values
+const uint8_t RTC_INT_PIN = 2;
+#define BOARD_HAS_RTC_INT 1
+#elif defined(BOARD_JUDE)
+// irrigation_engr_jude, Nano ATmega328; D2 drives the alarm, so the RTC INT
+// output is not wired
+const uint8_t ALARM_PIN = 2;
+const uint8_t MENU_PIN = 12;       // Button for menu navigation and selection
+const uint8_t SELECT_PIN = 11;     // Button for decreasing values
+const uint8_t IRRIGATION_PIN = 13;
+const uint8_t SWITCH_PIN = 10;     // Button for increasing values
+#else
+#error "Select the board profile with -D BOARD_NOEL or -D BOARD_JUDE"
+#endif
+
+#if defined(LOW_POWER_SLEEP) && !defined(BOARD_HAS_RTC_INT)
+#error "LOW_POWER_SLEEP needs a board profile with the RTC INT pin wired"
+#endif
+
+typedef FastPin<ALARM_PIN> AlarmOutput;
+typedef FastPin<IRRIGATION_PIN> IrrigationOutput;
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef BoardZones_h
+#define BoardZones_h
+
+// Valves wired on each board profile (see BoardConfig.h). This sizes the
+// irrigation core's zone table, which every translation unit of the core must
+// agree on, so it lives apart from the pin map and the core includes it
+// without pulling in the Arduino headers. Host builds have no board profile
+// and set -D MAX_ZONES=n instead.
+#if defined(BOARD_NOEL)
+#define MAX_ZONES 1
+#elif defined(BOARD_JUDE)
+#define MAX_ZONES 1
+#else
+#error "Select the board profile with -D BOARD_NOEL or -D BOARD_JUDE, or the zone count with -D MAX_ZONES=n"
+#endif
+
+#endif
@@ -0,0 +1,230 @@
+#include "Buttons.h"
+#include <PinChange.h>
+#include <avr/interrupt.h>
+
+// Gestures already sent for a press (Button::sent)
+const uint8_t SENT_LONG = 1;
+const uint8_t SENT_REPEAT = 2;
+const uint8_t IGNORE_PRESS = 4;  // Held since power-up: ignored until released
+const uint8_t CLICK_PENDING = 8; // Short press released, waiting to see if a second one follows
+
+Buttons buttons;
+
+// Debounce and gesture tick, about once per millisecond while armed
+ISR(TIMER0_COMPA_vect) {
+  buttons.tick();
+}
+
+static void buttonsPinChanged() {
+  buttons.pinChanged();
+}
+
+const ButtonTiming defaultTiming = {
+  BUTTON_DEBOUNCE_MS, BUTTON_LONG_MS, BUTTON_REPEAT_DELAY_MS, BUTTON_REPEAT_MS, BUTTON_DOUBLE_CLICK_MS
+};
+
+Buttons::Buttons() : _portCount(0), _count(0), _timing(defaultTiming), _head(0), _queued(0) {
+#ifdef BUTTONS_PROFILE
+  _maxTickMicros = 0;
+#endif
+}
+
+uint8_t Buttons::add(uint8_t pin, uint8_t options) {
+  if (_count == MAX_BUTTONS) {
+    return _count - 1;
+  }
+
+  // Buttons on the same port share one register read per sample
+  volatile uint8_t *port = portInputRegister(digitalPinToPort(pin));
+  uint8_t portIndex = 0;
+  while (portIndex < _portCount && _ports[portIndex] != port) {
+    portIndex++;
+  }
+  if (portIndex == _portCount) {
+    if (_portCount == MAX_BUTTON_PORTS) {
+      return _count - 1;
+    }
+    _ports[_portCount++] = port;
+  }
+  pinMode(pin, INPUT_PULLUP);
+
+  Button &button = _buttons[_count];
+  button.port = portIndex;
+  button.mask = digitalPinToBitMask(pin);
+  button.options = options;
+  button.raw = (*port & button.mask) ? 0 : 1;
+  button.stable = button.raw;
+  // A button held at power-up must be released before it counts
+  button.sent = button.stable ? IGNORE_PRESS : 0;
+  button.changedAt = millis();
+  button.pressedAt = button.changedAt;
+  button.nextRepeat = button.changedAt;
+  button.releasedAt = button.changedAt;
+  pinChangeEnable(pin, true);
+  return _count++;
+}
+
+void Buttons::begin() {
+  OCR0A = 0x80;  // Any value; the compare matches once per Timer0 cycle
+  pinChangeSetHandler(buttonsPinChanged);
+  startTick();
+}
+
+void Buttons::setTiming(const ButtonTiming &timing) {
+  uint8_t oldSREG = SREG;
+  cli();
+  _timing = timing;
+  SREG = oldSREG;
+}
+
+void Buttons::startTick() {
+  TIFR0 = _BV(OCF0A);
+  TIMSK0 |= _BV(OCIE0A);
+}
+
+// Read every button port once and timestamp the buttons whose level changed
+void Buttons::sample(uint16_t now) {
+  uint8_t levels[MAX_BUTTON_PORTS];
+  for (uint8_t i = 0; i < _portCount; i++) {
+    levels[i] = *_ports[i];
+  }
+  for (uint8_t i = 0; i < _count; i++) {
+    Button &button = _buttons[i];
+    uint8_t level = (levels[button.port] & button.mask) ? 0 : 1;
+    if (level != button.raw) {
+      button.raw = level;
+      button.changedAt = now;
+    }
+  }
+}
+
+/**
+ * The function `pinChanged` runs from the pin-change interrupt and timestamps every edge on a
+ * button pin. The level is not trusted yet; `tick()` accepts it once the pin is quiet.
+ */
+void Buttons::pinChanged() {
+  sample(millis());
+  startTick();
+}
+
+/**
+ * The function `tick` samples and debounces every button and classifies presses. It switches
+ * itself off once no button is bouncing, held or waiting for a second click.
+ */
+void Buttons::tick() {
+#ifdef BUTTONS_PROFILE
+  uint16_t startedAt = micros();
+#endif
+  uint16_t now = millis();
+  bool busy = false;
+
+  sample(now);
+  for (uint8_t i = 0; i < _count; i++) {
+    Button &button = _buttons[i];
+
+    // A click nobody followed up in time is a plain short press
+    if ((button.sent & CLICK_PENDING) && (uint16_t)(now - button.releasedAt) >= _timing.doubleClick) {
+      push(i, BUTTON_SHORT, button.releasedAt);
+      button.sent &= ~CLICK_PENDING;
+    }
+
+    if (button.raw != button.stable && (uint16_t)(now - button.changedAt) >= _timing.debounce) {
+      button.stable = button.raw;
+      if (button.stable) {
+        button.pressedAt = now;
+        button.nextRepeat = now + _timing.repeatDelay;
+        button.sent &= CLICK_PENDING;
+      } else if (button.sent == CLICK_PENDING) {
+        push(i, BUTTON_DOUBLE, now);
+        button.sent = 0;
+      } else if (button.sent == 0) {
+        if (button.options & BUTTON_DOUBLE_CLICK) {
+          button.releasedAt = now;
+          button.sent = CLICK_PENDING;
+        } else {
+          push(i, BUTTON_SHORT, now);
+        }
+      }
+    }
+
+    if (button.stable && !(button.sent & IGNORE_PRESS)) {
+      bool longDue = !(button.sent & SENT_LONG) && (uint16_t)(now - button.pressedAt) >= _timing.longPress;
+      bool repeatDue = (int16_t)(now - button.nextRepeat) >= 0;
+      if ((longDue || repeatDue) && (button.sent & CLICK_PENDING)) {
+        push(i, BUTTON_SHORT, button.releasedAt);
+        button.sent &= ~CLICK_PENDING;
+      }
+      if (longDue) {
+        push(i, BUTTON_LONG, now);
+        button.sent |= SENT_LONG;
+      }
+      if (repeatDue) {
+        push(i, BUTTON_REPEAT, now);
+        button.sent |= SENT_REPEAT;
+        button.nextRepeat += _timing.repeat;
+      }
+    }
+
+    busy = busy || button.stable || button.raw != button.stable || (button.sent & CLICK_PENDING);
+  }
+
+  if (!busy) {
+    TIMSK0 &= ~_BV(OCIE0A);
+  }
+
+#ifdef BUTTONS_PROFILE
+  uint16_t elapsed = (uint16_t)micros() - startedAt;
+  if (elapsed > _maxTickMicros) {
+    _maxTickMicros = elapsed;
+  }
+#endif
+}
+
+// Queue a gesture; when the main loop has fallen this far behind, the newest one is dropped
+void Buttons::push(uint8_t button, uint8_t gesture, uint16_t now) {
+  if (_queued == BUTTON_QUEUE_SIZE) {
+    return;
+  }
+  ButtonEvent &event = _queue[_head];
+  event.button = button;
+  event.gesture = gesture;
+  event.time = now;
+  _head = (_head + 1) % BUTTON_QUEUE_SIZE;
+  _queued++;
+}
+
+bool Buttons::read(ButtonEvent &event) {
+  bool found = false;
+  uint8_t oldSREG = SREG;
+  cli();
+  if (_queued > 0) {
+    event = _queue[(_head + BUTTON_QUEUE_SIZE - _queued) % BUTTON_QUEUE_SIZE];
+    _queued--;
+    found = true;
+  }
+  SREG = oldSREG;
+  return found;
+}
+
+bool Buttons::available() {
+  return _queued > 0;
+}
+
+bool Buttons::down(uint8_t button) {
+  return button < _count && _buttons[button].stable;
+}
+
+// tick() disarms itself once nothing is pending, and pinChanged() rearms it
+bool Buttons::busy() {
+  return TIMSK0 & _BV(OCIE0A);
+}
+
+#ifdef BUTTONS_PROFILE
+uint16_t Buttons::maxTickMicros() {
+  uint8_t oldSREG = SREG;
+  cli();
+  uint16_t value = _maxTickMicros;
+  SREG = oldSREG;
+  return value;
+}
+#endif
@@ -0,0 +1,139 @@
+#ifndef Buttons_h
+#define Buttons_h
+
+#include <Arduino.h>
+
+#ifndef MAX_BUTTONS
+#define MAX_BUTTONS 4
+#endif
+
+// Distinct I/O ports the buttons sit on (PINB/PINC/PIND on the ATmega328)
+#ifndef MAX_BUTTON_PORTS
+#define MAX_BUTTON_PORTS 3
+#endif
+
+// Gesture events queued for the main loop; holds a few presses of backlog
+#ifndef BUTTON_QUEUE_SIZE
+#define BUTTON_QUEUE_SIZE 8
+#endif
+
+enum ButtonGesture {
+  BUTTON_SHORT,   // Released before the long-press time, with no repeats sent
+  BUTTON_LONG,    // Held for the long-press time; sent once per press
+  BUTTON_REPEAT,  // Still held: first after the repeat delay, then every repeat period
+  BUTTON_DOUBLE   // Two short presses within the double-click time (BUTTON_DOUBLE_CLICK buttons only)
+};
+
+// Options for Buttons::add()
+const uint8_t BUTTON_DOUBLE_CLICK = 1;  // Recognise double clicks; a single short press is sent
+                                        // only once the double-click time has passed
+
+struct ButtonEvent {
+  uint8_t button;   // Index returned by Buttons::add()
+  uint8_t gesture;  // ButtonGesture
+  uint16_t time;    // Low 16 bits of millis() when the gesture was recognised
+};
+
+const uint16_t BUTTON_DEBOUNCE_MS = 5;
+const uint16_t BUTTON_LONG_MS = 2000;
+const uint16_t BUTTON_REPEAT_DELAY_MS = 500;
+const uint16_t BUTTON_REPEAT_MS = 200;
+const uint16_t BUTTON_DOUBLE_CLICK_MS = 300;
+
+// Gesture thresholds in milliseconds, shared by all buttons; the defaults are
+// the constants above
+struct ButtonTiming {
+  uint16_t debounce;     // Quiet time before a new level is accepted
+  uint16_t longPress;    // Hold time for BUTTON_LONG
+  uint16_t repeatDelay;  // Hold time before the first BUTTON_REPEAT
+  uint16_t repeat;       // Period of the following repeats
+  uint16_t doubleClick;  // Longest gap between the two presses of a double click
+};
+
+// Interrupt-driven, debounced push buttons (active low, internal pull-ups).
+//
+// A pin-change interrupt timestamps every edge on a button pin. A 1 kHz tick
+// on the Timer0 compare A interrupt (Timer0 keeps running for millis(); the
+// compare only fires an extra interrupt) samples the pins again, accepts a
+// new level once a pin has been quiet for the debounce time and turns presses
+// into short, long, repeat and double-click gestures, queued with their
+// timestamps for read(). The tick only runs while a button is bouncing, held
+// or waiting for a second click, so an idle board takes no interrupts.
+//
+// Each button keeps its own state, and every sample reads each port register
+// once for all the buttons on it. A tick costs a fixed amount per port and per
+// button, so its worst case is set by MAX_BUTTON_PORTS and MAX_BUTTONS; build
+// with -D BUTTONS_PROFILE to record it (maxTickMicros()). No figure has been
+// measured on a board yet.
+//
+// Timer0 stops in power-down, and with it the tick: a board that sleeps must
+// stay awake while busy(), or a press still being debounced is lost.
+//
+// The main loop never waits to debounce: it drains read() once per pass and a
+// gesture is available within a few milliseconds of the press or release.
+//
+// Uses PCINT through the PinChange library and owns TIMER0_COMPA_vect, so PWM
+// on pin 6 (OC0A) is not available.
+class Buttons {
+public:
+  Buttons();
+
+  // Register a button on pin; returns its index (in registration order)
+  uint8_t add(uint8_t pin, uint8_t options = 0);
+  // Enable the interrupts once all buttons are added
+  void begin();
+  void setTiming(const ButtonTiming &timing);
+
+  // Pop the oldest gesture; false if none is waiting
+  bool read(ButtonEvent &event);
+  // True if a gesture is waiting for read()
+  bool available();
+  // Debounced level
+  bool down(uint8_t button);
+  // True while the tick runs: a button is bouncing, held or waiting for a
+  // second click
+  bool busy();
+
+  // Interrupt entry points
+  void pinChanged();
+  void tick();
+
+#ifdef BUTTONS_PROFILE
+  // Longest tick() so far, in microseconds (4 us resolution at 16 MHz)
+  uint16_t maxTickMicros();
+#endif
+
+private:
+  struct Button {
+    uint8_t port;           // Index into _ports
+    uint8_t mask;
+    uint8_t options;
+    uint8_t raw;            // Last sampled level, 1 = pressed
+    uint8_t stable;         // Debounced level
+    uint8_t sent;           // Gestures already sent for the current press
+    uint16_t changedAt;     // Time of the last raw edge
+    uint16_t pressedAt;     // Time the debounced press started
+    uint16_t nextRepeat;    // Time the next repeat is due
+    uint16_t releasedAt;    // Time a click waiting for its second press was released
+  };
+
+  void sample(uint16_t now);
+  void push(uint8_t button, uint8_t gesture, uint16_t now);
+  void startTick();
+
+  volatile uint8_t *_ports[MAX_BUTTON_PORTS];  // PINx registers
+  uint8_t _portCount;
+  Button _buttons[MAX_BUTTONS];
+  uint8_t _count;
+  ButtonTiming _timing;
+#ifdef BUTTONS_PROFILE
+  volatile uint16_t _maxTickMicros;
+#endif
+  ButtonEvent _queue[BUTTON_QUEUE_SIZE];
+  volatile uint8_t _head;   // Next free entry
+  volatile uint8_t _queued; // Entries waiting
+};
+
+extern Buttons buttons;
+
+#endif
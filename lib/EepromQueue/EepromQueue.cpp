@@ -0,0 +1,141 @@
+#include "EepromQueue.h"
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
+
+static_assert((EEPROM_QUEUE_SIZE & (EEPROM_QUEUE_SIZE - 1)) == 0, "EEPROM_QUEUE_SIZE must be a power of two");
+static_assert(EEPROM_QUEUE_SIZE < 256, "EEPROM_QUEUE_SIZE must fit in a byte");
+
+const uint8_t QUEUE_MASK = EEPROM_QUEUE_SIZE - 1;
+
+EepromQueue eepromQueue;
+
+// Fires whenever the EEPROM is ready and EERIE is set
+ISR(EE_READY_vect) {
+  eepromQueue.service();
+}
+
+EepromQueue::EepromQueue() : _head(0), _count(0) {
+}
+
+void EepromQueue::service() {
+  if (_count == 0) {
+    // Nothing left; stop the interrupt until the next write()
+    EECR &= ~_BV(EERIE);
+    return;
+  }
+
+  uint8_t tail = (_head - _count) & QUEUE_MASK;
+  EEAR = _address[tail];
+  EEDR = _value[tail];
+  // Erase and write in one operation; EEPE must follow EEMPE within 4 cycles,
+  // which holds here because interrupts are off inside the ISR
+  EECR = _BV(EERIE) | _BV(EEMPE);
+  EECR |= _BV(EEPE);
+  _count--;
+}
+
+void EepromQueue::write(uint16_t address, uint8_t value) {
+  // Full: wait for the interrupt to free an entry
+  while (_count == EEPROM_QUEUE_SIZE) {
+  }
+  push(address, value);
+  EECR |= _BV(EERIE);
+}
+
+// Add an entry; the writer only picks it up once EERIE is set
+void EepromQueue::push(uint16_t address, uint8_t value) {
+  uint8_t oldSREG = SREG;
+  cli();
+  _address[_head] = address;
+  _value[_head] = value;
+  _head = (_head + 1) & QUEUE_MASK;
+  _count++;
+  SREG = oldSREG;
+}
+
+// The newest queued value for the address, if any; call with interrupts off
+bool EepromQueue::queued(uint16_t address, uint8_t &value) {
+  for (uint8_t i = 1; i <= _count; i++) {
+    uint8_t entry = (_head - i) & QUEUE_MASK;
+    if (_address[entry] == address) {
+      value = _value[entry];
+      return true;
+    }
+  }
+  return false;
+}
+
+uint8_t EepromQueue::read(uint16_t address) {
+  uint8_t oldSREG = SREG;
+  cli();
+  uint8_t value;
+  if (queued(address, value)) {
+    SREG = oldSREG;
+    return value;
+  }
+
+  // Hold the writer so it cannot start another write under us, then let a
+  // write already in progress finish before touching EEAR
+  EECR &= ~_BV(EERIE);
+  SREG = oldSREG;
+  eeprom_busy_wait();
+  value = eeprom_read_byte((const uint8_t *)address);
+  if (_count > 0) {
+    EECR |= _BV(EERIE);
+  }
+  return value;
+}
+
+/**
+ * The function `update` queues the bytes of `data` that differ from the EEPROM at `address`, as
+ * later queued writes will leave it. The writer is held for the whole compare, so the bytes queued
+ * here do not start one by one under it: only a write already running when it is called is waited
+ * for, once. A range with more changed bytes than the queue holds lets the writer go to make room,
+ * and the compare then waits on the EEPROM again.
+ */
+void EepromQueue::update(uint16_t address, const uint8_t *data, uint16_t size) {
+  uint8_t oldSREG = SREG;
+  cli();
+  EECR &= ~_BV(EERIE);
+  SREG = oldSREG;
+
+  for (uint16_t i = 0; i < size; i++) {
+    cli();
+    uint8_t value;
+    bool found = queued(address + i, value);
+    SREG = oldSREG;
+    if (!found) {
+      eeprom_busy_wait();
+      value = eeprom_read_byte((const uint8_t *)(address + i));
+    }
+    if (value == data[i]) {
+      continue;
+    }
+    if (_count == EEPROM_QUEUE_SIZE) {
+      EECR |= _BV(EERIE);
+      while (_count == EEPROM_QUEUE_SIZE) {
+      }
+      cli();
+      EECR &= ~_BV(EERIE);
+      SREG = oldSREG;
+    }
+    push(address + i, data[i]);
+  }
+
+  if (_count > 0) {
+    EECR |= _BV(EERIE);
+  }
+}
+
+uint8_t EepromQueue::pending() {
+  return _count + ((EECR & _BV(EEPE)) ? 1 : 0);
+}
+
+bool EepromQueue::done() {
+  return pending() == 0;
+}
+
+void EepromQueue::flush() {
+  while (!done()) {
+  }
+}
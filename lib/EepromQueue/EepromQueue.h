@@ -0,0 +1,60 @@
+#ifndef EepromQueue_h
+#define EepromQueue_h
+
+#include <Arduino.h>
+
+// Bytes that can wait for the EEPROM at once (a power of two); each costs
+// 3 bytes of RAM
+#ifndef EEPROM_QUEUE_SIZE
+#define EEPROM_QUEUE_SIZE 16
+#endif
+
+// Non-blocking EEPROM writer.
+//
+// An EEPROM byte write takes about 3.3 ms, and EEPROM.write()/update() spin
+// for all of it. write() here only queues the (address, byte) pair; the
+// EE_READY interrupt starts the next queued write each time the EEPROM is
+// free, so a settings save returns immediately. write() only waits if the
+// queue is full.
+//
+// read() sees queued values, so read-compare-write code keeps working while
+// writes are pending; a byte that is not queued is read from the EEPROM, which
+// waits out a write in progress. update() is the compare-and-write without
+// that wait per byte: it holds the writer while it compares the whole range,
+// so it waits at most once, for a write that was already running, and only
+// then lets the changed bytes go. flush() waits for everything to reach the
+// EEPROM; call it before sleeping in power-down, where the interrupt cannot
+// run.
+//
+// This library owns the EE_READY vector.
+class EepromQueue {
+public:
+  EepromQueue();
+
+  void write(uint16_t address, uint8_t value);
+  uint8_t read(uint16_t address);
+  // Queue the bytes of data that differ from what the EEPROM will hold
+  void update(uint16_t address, const uint8_t *data, uint16_t size);
+
+  // Bytes queued or being written
+  uint8_t pending();
+  // True once every queued byte is in the EEPROM
+  bool done();
+  void flush();
+
+  // Start the next queued write; called from the EE_READY interrupt
+  void service();
+
+private:
+  void push(uint16_t address, uint8_t value);
+  bool queued(uint16_t address, uint8_t &value);
+
+  volatile uint16_t _address[EEPROM_QUEUE_SIZE];
+  volatile uint8_t _value[EEPROM_QUEUE_SIZE];
+  volatile uint8_t _head;   // Next free entry
+  volatile uint8_t _count;  // Entries waiting
+};
+
+extern EepromQueue eepromQueue;
+
+#endif
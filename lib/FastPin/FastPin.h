@@ -0,0 +1,45 @@
+#ifndef FastPin_h
+#define FastPin_h
+
+#include <Arduino.h>
+
+// Digital pin fixed at compile time, for the ATmega168/328 Nano pin map
+// (D0-D7 on PORTD, D8-D13 on PORTB, A0-A5 as 14-19 on PORTC).
+//
+// digitalRead()/digitalWrite() look the pin up in flash tables and check for
+// PWM on every call, about 50 cycles each. With the pin a template argument
+// the register and the bit are constants, so write(), high() and low() compile
+// to a single SBI/CBI and pressed()/read() to a SBIS/SBIC skip. SBI and CBI
+// are atomic, so these are safe next to interrupts touching the same port.
+template <uint8_t Pin>
+struct FastPin {
+  static_assert(Pin < 20, "FastPin only knows the Nano pins 0-19");
+
+  static const uint8_t mask = 1 << (Pin < 8 ? Pin : Pin < 14 ? Pin - 8 : Pin - 14);
+
+  static inline volatile uint8_t &portRegister() { return Pin < 8 ? PORTD : Pin < 14 ? PORTB : PORTC; }
+  static inline volatile uint8_t &pinRegister() { return Pin < 8 ? PIND : Pin < 14 ? PINB : PINC; }
+  static inline volatile uint8_t &ddrRegister() { return Pin < 8 ? DDRD : Pin < 14 ? DDRB : DDRC; }
+
+  static inline void output() { ddrRegister() |= mask; }
+  static inline void inputPullup() {
+    ddrRegister() &= ~mask;
+    portRegister() |= mask;
+  }
+
+  static inline void high() { portRegister() |= mask; }
+  static inline void low() { portRegister() &= ~mask; }
+  static inline void write(bool on) {
+    if (on) {
+      high();
+    } else {
+      low();
+    }
+  }
+
+  static inline bool read() { return pinRegister() & mask; }
+  // Active-low button with the pull-up enabled
+  static inline bool pressed() { return !(pinRegister() & mask); }
+};
+
+#endif
@@ -0,0 +1,231 @@
+#include <SPI.h>
+#include <Wire.h>
+#include <RTClib.h>
+#include <LiquidCrystal_I2C.h>
+#include <BatchedLcd.h>
+#include <LcdFrame.h>
+#include <RtcClock.h>
+#ifdef LOW_POWER_SLEEP
+#include <RtcSleep.h>
+#endif
+#include <EepromQueue.h>
+#include <TwiQueue.h>
+#include <Buttons.h>
+#include <Irrigation.h>
+#include <BoardConfig.h>  // Pins and features of the board profile
+#include "IrrigationBoard.h"
+
+// Define LCD and RTC objects
+BatchedLcd lcd(0x27, 16, 2);  // Packs each screen update into a few Wire transactions
+LcdFrame frame(lcd);  // Screens render here; frame.flush() sends only the changed cells
+RTC_DS3231 rtc;
+RtcClock rtcClock(rtc);  // Reads the DS3231 at most once per second
+#ifdef LOW_POWER_SLEEP
+RtcSleep rtcSleep(rtc);  // Powers down between events, woken by Alarm1 or a button
+#endif
+
+// Factory zone table, one entry per valve wired on the board:
+// { pin, enabled, duration, interval, window start, window end }, times in minutes
+const Zone factoryZones[] = {
+  { IRRIGATION_PIN, 1, 30, 360, 6 * 60, 18 * 60 },  // Spray 30 minutes every 6 hours, 6 AM to 6 PM
+};
+const uint8_t factoryZoneCount = sizeof(factoryZones) / sizeof(factoryZones[0]);
+static_assert(sizeof(factoryZones) / sizeof(factoryZones[0]) == MAX_ZONES,
+              "MAX_ZONES in BoardZones.h must match the valves in factoryZones");
+static_assert(ADDR_JOURNAL + 2 * JOURNAL_RECORD_SIZE + RUN_LOG_SIZE <= E2END + 1,
+              "Settings journal and run log do not fit in this chip's EEPROM");
+
+// Longest pause between loop passes when the board does not sleep
+const unsigned long IDLE_MS = 100;
+
+// Hardware abstraction for the irrigation core (see IrrigationHal.h)
+
+unsigned long halMillis() {
+  return millis();
+}
+
+void halDelay(unsigned long ms) {
+  delay(ms);
+}
+
+// Time of day from the cached second of the day; no DateTime is built
+ClockTime halNow() {
+  ClockTime time;
+  time.unixtime = rtcClock.unixtime();
+  uint32_t secondOfDay = rtcClock.secondOfDay();
+  uint16_t minuteOfDay = secondOfDay / 60;
+  time.hour = minuteOfDay / 60;
+  time.minute = minuteOfDay % 60;
+  time.second = secondOfDay - minuteOfDay * 60UL;
+  return time;
+}
+
+#ifdef LOW_POWER_SLEEP
+// The button tick runs on Timer0, which stops in power-down
+static bool buttonsBusy() {
+  return buttons.busy();
+}
+#endif
+
+void halIdle(uint32_t wakeTime) {
+#ifdef LOW_POWER_SLEEP
+  // A press that is still debouncing has not reached the core yet
+  if (wakeTime != 0 && !buttons.busy()) {
+    // EE_READY cannot fire in power-down and the TWI clock stops; finish
+    // pending settings writes and LCD transfers first
+    eepromQueue.flush();
+    twiQueue.flush();
+    rtcSleep.sleepUntil(rtcClock.now(), DateTime(wakeTime));
+    // millis() stood still while asleep. A sleep lasts a minute at most, so
+    // the time-of-day registers are enough to catch up; RtcClock rolls the
+    // date over at midnight
+    rtcClock.readSecondOfDay();
+    return;
+  }
+#endif
+  // Hand a gesture to the core as soon as the debouncer has it, not at the
+  // end of the pause, so the screen answers a press within a few ms
+  unsigned long start = millis();
+  while (millis() - start < IDLE_MS && !buttons.available()) {
+  }
+}
+
+// The buttons are registered in HalButton order, so the indices match
+bool halButtonDown(HalButton button) {
+  return buttons.down(button);
+}
+
+bool halButtonEvent(HalButtonEvent &event) {
+  ButtonEvent pressed;
+  if (!buttons.read(pressed)) {
+    return false;
+  }
+  event.button = (HalButton)pressed.button;
+  switch (pressed.gesture) {
+    case BUTTON_SHORT: event.gesture = GESTURE_SHORT; break;
+    case BUTTON_LONG: event.gesture = GESTURE_LONG; break;
+    case BUTTON_DOUBLE: event.gesture = GESTURE_DOUBLE; break;
+    default: event.gesture = GESTURE_REPEAT; break;
+  }
+  return true;
+}
+
+void halSetAlarm(bool on) {
+  AlarmOutput::write(on);
+}
+
+// The valve wired on this board is switched directly; other zone pins go
+// through the Arduino core
+void halSetValve(uint8_t pin, bool on) {
+  if (pin == IRRIGATION_PIN) {
+    IrrigationOutput::write(on);
+  } else {
+    digitalWrite(pin, on ? HIGH : LOW);
+  }
+}
+
+size_t halStorageSize() {
+  return E2END + 1;
+}
+
+// EEPROM writes are queued and drained by the EE_READY interrupt, so saving
+// settings does not wait for the EEPROM; reads see the queued values
+void halStorageRead(int address, void *data, size_t size) {
+  uint8_t *bytes = (uint8_t *)data;
+  for (size_t i = 0; i < size; i++) {
+    bytes[i] = eepromQueue.read(address + i);
+  }
+}
+
+// Compares the whole range before any changed byte starts writing: a
+// compare-then-write per byte would wait out each byte written before it
+void halStorageWrite(int address, const void *data, size_t size) {
+  eepromQueue.update(address, (const uint8_t *)data, size);
+}
+
+void halLog(const char *message) {
+  Serial.println((const __FlashStringHelper *)message);
+}
+
+void boardSetup() {
+  Serial.begin(9600);
+
+  // Initialize LCD and RTC
+  lcd.init();
+  lcd.backlight();
+  
+  if (!rtc.begin()) {
+    Serial.println(F("Couldn't find RTC"));
+    while (1);
+  }
+
+  // Take the first snapshot, time and status in one read; loop() refreshes
+  // the time once per pass
+  rtcClock.begin();
+  if (rtcClock.snapshot().lostPower()) {
+    Serial.println(F("RTC lost power, setting the time!"));
+    rtc.adjust(DateTime(F(__DATE__), F(__TIME__))); // Set RTC to compile time if power was lost
+    rtcClock.resync();
+  }
+
+  //  RTCTime startTime(02, Month::NOVEMBER, 2024, 14, 27, 00, DayOfWeek::SUNDAY, SaveLight::SAVING_TIME_ACTIVE);
+
+  // RTC.setTime(startTime);
+  //  rtc.adjust(DateTime(2024, 11, 03, 14, 34, 20));
+
+  // Initialize pins
+  AlarmOutput::output();
+  for (uint8_t i = 0; i < factoryZoneCount; i++) {
+    pinMode(factoryZones[i].pin, OUTPUT);
+  }
+  // Debounced in the background by pin-change and timer interrupts
+  buttons.add(MENU_PIN);
+  buttons.add(SELECT_PIN);
+  buttons.add(SWITCH_PIN);
+  buttons.begin();
+
+#ifdef LOW_POWER_SLEEP
+  // The button pin-change interrupts stay enabled and wake it as well
+  rtcSleep.begin(RTC_INT_PIN);
+  rtcSleep.setKeepAwake(buttonsBusy);
+#endif
+
+  // Load settings, schedule the first run and show the main screen
+  irrigationSetup(factoryZones, factoryZoneCount);
+}
+
+void boardLoop() {
+#ifdef BUTTONS_PROFILE
+  // Worst-case button tick so far, whenever it grows
+  static uint16_t maxTickMicros = 0;
+  if (buttons.maxTickMicros() > maxTickMicros) {
+    maxTickMicros = buttons.maxTickMicros();
+    Serial.print(F("buttons tick max us: "));
+    Serial.println(maxTickMicros);
+  }
+#endif
+#ifdef TWI_QUEUE_PROFILE
+  // Bus load over the last 10 seconds
+  static unsigned long reportedAt = 0;
+  static TwiStats reported;
+  if (millis() - reportedAt >= 10000) {
+    TwiStats stats;
+    twiQueue.stats(stats);
+    unsigned long elapsed = millis() - reportedAt;
+    Serial.print(F("twi: "));
+    Serial.print(stats.transactions - reported.transactions);
+    Serial.print(F(" transactions, "));
+    Serial.print(stats.bytes - reported.bytes);
+    Serial.print(F(" bytes, bus busy "));
+    Serial.print((stats.busMicros - reported.busMicros) / (elapsed * 10.0), 2);
+    Serial.print(F("%, CPU in ISR "));
+    Serial.print((stats.isrMicros - reported.isrMicros) / (elapsed * 10.0), 2);
+    Serial.println(F("%"));
+    reported = stats;
+    reportedAt = millis();
+  }
+#endif
+  rtcClock.tick();
+  // Ends in halIdle(), which paces the loop or sleeps
+  irrigationLoop();
+}
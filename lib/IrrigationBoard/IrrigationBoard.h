@@ -0,0 +1,12 @@
+#ifndef IrrigationBoard_h
+#define IrrigationBoard_h
+
+// The irrigation firmware for the Nano boards: the LCD, the DS3231, the
+// buttons, the EEPROM queue and the hardware layer the irrigation core runs
+// on (IrrigationHal.h). Pins and features come from the board profile in
+// BoardConfig.h, so each firmware's main.cpp only forwards setup() and
+// loop() here.
+void boardSetup();
+void boardLoop();
+
+#endif
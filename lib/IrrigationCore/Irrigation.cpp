@@ -0,0 +1,585 @@
+#include <string.h>
+#include "Irrigation.h"
+
+// Zone table (settings) and the per-zone scheduler/run engine state
+Zone zones[MAX_ZONES];
+ZoneRun zoneRuns[MAX_ZONES];
+uint8_t zoneCount = 0;
+uint8_t nextZone = NO_ZONE;
+RunPolicy runPolicy = RUN_SEQUENTIAL;
+CatchUpPolicy catchUpPolicy = CATCH_UP_SHORTEN;
+ClockTime currentTime;
+
+const unsigned long alarmPulseDuration = 1000; // Alarm/relay pulse at the start of a run
+
+void saveSettings() {
+  // Appends to the wear-leveled journal; unchanged bytes are not rewritten
+  journalSave(zones, sizeof(zones));
+}
+
+// Zone 0 inherits the single schedule kept by firmware before the zone table
+static void loadLegacySchedule(Zone &zone) {
+  int sprayMinutes, sprayDuration, startHour, startMinute, endHour, endMinute;
+  halStorageRead(ADDR_SPRAY_MINUTES, &sprayMinutes, sizeof(sprayMinutes));
+  halStorageRead(ADDR_SPRAY_DURATION, &sprayDuration, sizeof(sprayDuration));
+  halStorageRead(ADDR_START_HOUR, &startHour, sizeof(startHour));
+  halStorageRead(ADDR_START_MINUTE, &startMinute, sizeof(startMinute));
+  halStorageRead(ADDR_END_HOUR, &endHour, sizeof(endHour));
+  halStorageRead(ADDR_END_MINUTE, &endMinute, sizeof(endMinute));
+
+  // Validate loaded values; anything out of range keeps the factory setting
+  if (sprayMinutes >= 30 && sprayMinutes <= 1440) zone.interval = sprayMinutes;
+  if (sprayDuration >= 1 && sprayDuration <= 120) zone.duration = sprayDuration;
+  if (startHour < 0 || startHour > 23) startHour = zone.start / 60;
+  if (startMinute < 0 || startMinute > 59) startMinute = zone.start % 60;
+  if (endHour < 0 || endHour > 23) endHour = zone.end / 60;
+  if (endMinute < 0 || endMinute > 59) endMinute = zone.end % 60;
+  zone.start = startHour * 60 + startMinute;
+  zone.end = endHour * 60 + endMinute;
+}
+
+// A stored zone is only trusted if it still drives the pin the board wires for it
+static bool validZone(const Zone &zone, const Zone &factory) {
+  return zone.pin == factory.pin &&
+         zone.interval >= 30 && zone.interval <= 1440 &&
+         zone.duration >= 1 && zone.duration <= 120 &&
+         zone.start < 24 * 60 && zone.end < 24 * 60;
+}
+
+void loadSettings(const Zone *factoryZones) {
+  if (!journalLoad(zones, sizeof(zones))) {
+    // Blank storage, or the first boot after an upgrade from a single schedule
+    memcpy(zones, factoryZones, zoneCount * sizeof(Zone));
+    loadLegacySchedule(zones[0]);
+  }
+
+  for (uint8_t i = 0; i < zoneCount; i++) {
+    if (!validZone(zones[i], factoryZones[i])) {
+      zones[i] = factoryZones[i];
+    }
+  }
+}
+
+void irrigationSetup(const Zone *factoryZones, uint8_t count) {
+  zoneCount = count < MAX_ZONES ? count : MAX_ZONES;
+  memset(zoneRuns, 0, sizeof(zoneRuns));
+  loadSettings(factoryZones);
+  currentTime = halNow();
+
+  uint32_t completed[MAX_ZONES];
+  runLogLoad(completed, zoneCount, currentTime.unixtime);
+  for (uint8_t i = 0; i < zoneCount; i++) {
+    zoneRuns[i].doneSprayTime = completed[i];
+    if (completed[i] != 0) {
+      zoneRuns[i].firedSlot = slotId(zones[i], completed[i]);
+    }
+  }
+
+  // Start with every valve closed
+  for (uint8_t i = 0; i < zoneCount; i++) {
+    halSetValve(zones[i].pin, false);
+  }
+
+  // Calculate initial next spray times, and deal with a run the board was
+  // off for
+  calculateNextSprayTimes();
+  catchUpMissedRuns();
+
+  // Display default info on LCD
+  displayTimeAndSettings();
+  frame.flush();
+}
+
+void irrigationLoop() {
+  // One time snapshot per pass, shared by the display and the scheduler
+  currentTime = halNow();
+
+  // Long press on Menu opens the menu; inside it every gesture is one menu step
+  HalButtonEvent event = nextButtonEvent();
+  if (currentMenu == MAIN) {
+    if (isGesture(event, BUTTON_MENU, GESTURE_LONG)) {
+      openMenu(BUTTON_MENU);
+    }
+  } else {
+    menuStep(event);
+  }
+
+  // Show the menu, the running cycle, or the time and settings
+  if (currentMenu != MAIN) {
+    renderMenu();
+  } else if (irrigationBusy()) {
+    displayIrrigationStatus();
+  } else {
+    displayTimeAndSettings();
+  }
+
+  // The schedule keeps running while the menu is open
+  checkIrrigation();
+
+  // Advance a running irrigation cycle, if any
+  updateIrrigation();
+
+  // Push whatever changed on screen this pass
+  frame.flush();
+
+  // Let the platform pause (or sleep) until something needs doing
+  halIdle(nextWakeTime());
+}
+
+/**
+ * The function `nextWakeTime` returns when the core next has work to do if left alone: the next
+ * spray start of any zone or the next change on the main screen. It returns 0 while a run, the
+ * menu or a held button needs the loop to keep ticking. Boards that power down between passes
+ * (LOW_POWER_SLEEP) only wake for the clock minute, since every wake costs an RTC read and an
+ * alarm reprogram.
+ */
+uint32_t nextWakeTime() {
+  if (irrigationBusy() || currentMenu != MAIN) {
+    return 0;
+  }
+  if (halButtonDown(BUTTON_MENU) || halButtonDown(BUTTON_SELECT) || halButtonDown(BUTTON_SWITCH)) {
+    return 0;
+  }
+
+#ifdef LOW_POWER_SLEEP
+  // The main screen changes with the clock minute
+  uint32_t wakeTime = currentTime.unixtime - currentTime.second + 60;
+#else
+  // The main screen changes every 5 seconds (clock minute, ST/NX alternation)
+  uint32_t wakeTime = currentTime.unixtime - currentTime.second % 5 + 5;
+#endif
+  if (nextZone != NO_ZONE) {
+    uint32_t sprayTime = zoneRuns[nextZone].nextSprayTime;
+    if (sprayTime > currentTime.unixtime && sprayTime < wakeTime) {
+      wakeTime = sprayTime;
+    }
+  }
+  return wakeTime;
+}
+
+// True while any zone is queued or running
+bool irrigationBusy() {
+  for (uint8_t i = 0; i < zoneCount; i++) {
+    if (zoneRuns[i].state != RUN_IDLE) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * The function `calculateNextSprayTimes` recompiles every zone's schedule, reschedules it and
+ * picks the zone that runs next. It is called at boot and whenever the menu changes the zone
+ * table.
+ */
+void calculateNextSprayTimes() {
+  for (uint8_t i = 0; i < zoneCount; i++) {
+    compileSchedule(i);
+    calculateNextSprayTime(i);
+  }
+  findNextZone();
+}
+
+// Remember the enabled zone with the earliest next spray start
+void findNextZone() {
+  nextZone = NO_ZONE;
+  for (uint8_t i = 0; i < zoneCount; i++) {
+    if (zones[i].enabled && (nextZone == NO_ZONE || zoneRuns[i].nextSprayTime < zoneRuns[nextZone].nextSprayTime)) {
+      nextZone = i;
+    }
+  }
+}
+
+// Length of the spray window; an end at or before the start wraps past midnight
+static int windowMinutes(const Zone &settings) {
+  int minutes = settings.end - settings.start;
+  return minutes > 0 ? minutes : minutes + 24 * 60;
+}
+
+// Minutes from the start of a slot to the end of the window, 0 from the
+// closing minute on
+static int slotWindowMinutes(const Zone &settings, uint8_t slot) {
+  int minutes = windowMinutes(settings) - slot * settings.interval;
+  return minutes > 0 ? minutes : 0;
+}
+
+/**
+ * The function `compileSchedule` turns a zone's settings into its daily run table. The slots of a
+ * window start at `start + k * interval` for k below `slotCount`, in order, and slot k runs for the
+ * zone's duration clipped to `slotWindowMinutes(k)`; so the table is kept as its slot count, and
+ * the scheduler only moves the `nextSlot` cursor through it. A slot on the window's closing minute
+ * would run for 0 minutes and is left out. Runs when the settings change.
+ */
+void compileSchedule(uint8_t zone) {
+  zoneRuns[zone].slotCount = (windowMinutes(zones[zone]) - 1) / zones[zone].interval + 1;
+}
+
+/**
+ * The function `calculateNextSprayTime` places the cursor on the first slot at or after the
+ * current time snapshot that has not fired yet, or on tomorrow's first slot once the window is used
+ * up. It runs at boot, when the settings change and when a run ends; in between the cursor just
+ * steps on with `advanceSlot()`.
+ */
+void calculateNextSprayTime(uint8_t zone) {
+  const Zone &settings = zones[zone];
+  ZoneRun &run = zoneRuns[zone];
+  int currentTimeInMinutes = currentTime.hour * 60 + currentTime.minute;
+  int minutesSinceStart = (currentTimeInMinutes - settings.start + 24 * 60) % (24 * 60);
+  unsigned long windowStart = currentTime.unixtime - currentTime.second - minutesSinceStart * 60UL;
+
+  // First slot at or after the current minute, in the window that opened last
+  run.nextSlot = (minutesSinceStart + settings.interval - 1) / settings.interval;
+  if (run.nextSlot < run.slotCount) {
+    run.nextSprayTime = windowStart + run.nextSlot * (settings.interval * 60UL);
+  } else {
+    run.nextSlot = 0;
+    run.nextSprayTime = windowStart + 86400UL;
+  }
+
+  // That slot already fired (settings saved during the run minute): take the following one
+  if (slotId(settings, run.nextSprayTime) == run.firedSlot) {
+    advanceSlot(zone);
+  }
+}
+
+// Step the cursor to the following slot, the first of the next window after the last one
+void advanceSlot(uint8_t zone) {
+  ZoneRun &run = zoneRuns[zone];
+  uint32_t intervalSeconds = zones[zone].interval * 60UL;
+  if (run.nextSlot + 1 < run.slotCount) {
+    run.nextSlot++;
+    run.nextSprayTime += intervalSeconds;
+  } else {
+    run.nextSprayTime += 86400UL - run.nextSlot * intervalSeconds;
+    run.nextSlot = 0;
+  }
+}
+
+/**
+ * The function `slotId` names a slot for good: the day its spray window opened (days since 1970)
+ * in the upper bits and its index in the window in the low byte. Slot starts map to one ID each
+ * however often they are computed, so comparing IDs is what makes a slot fire only once.
+ */
+uint32_t slotId(const Zone &settings, uint32_t sprayTime) {
+  uint32_t sinceWindowStart = sprayTime - settings.start * 60UL;
+  return (sinceWindowStart / 86400UL) << 8 | (sinceWindowStart % 86400UL / 60 / settings.interval);
+}
+
+// Start of the latest slot of a zone at or before the current minute
+uint32_t previousSprayTime(uint8_t zone) {
+  const Zone &settings = zones[zone];
+  int currentTimeInMinutes = currentTime.hour * 60 + currentTime.minute;
+  int minutesSinceStart = (currentTimeInMinutes - settings.start + 24 * 60) % (24 * 60);
+
+  // The last slot so far, or the last one of the window once it is over
+  uint8_t slot = minutesSinceStart / settings.interval;
+  if (slot >= zoneRuns[zone].slotCount) {
+    slot = zoneRuns[zone].slotCount - 1;
+  }
+  unsigned long windowStart = currentTime.unixtime - currentTime.second - minutesSinceStart * 60UL;
+  return windowStart + slot * (settings.interval * 60UL);
+}
+
+void displayTimeAndSettings() {
+  // Show the zone that runs next (the first one if every zone is disabled)
+  uint8_t shown = nextZone != NO_ZONE ? nextZone : 0;
+  const Zone &zone = zones[shown];
+
+  frame.clear();
+
+  // Display current time at the top
+  frame.setCursor(0, 0);
+  frame.printFlash(PSTR("T:"));
+  if (currentTime.hour < 10) frame.print('0');
+  frame.print(currentTime.hour);
+  frame.print(':');
+  if (currentTime.minute < 10) frame.print('0');
+  frame.print(currentTime.minute);
+  // Alternate the start time with the precomputed next run every 5 seconds.
+  // A sleeping board would only ever be seen on the minute, so it keeps to
+  // the next run; the start time is in the menu.
+#ifdef LOW_POWER_SLEEP
+  bool showStart = false;
+#else
+  bool showStart = currentTime.second % 10 < 5;
+#endif
+  if (showStart) {
+    frame.printFlash(PSTR(" ST:"));
+    frame.print(zone.start / 60);
+    frame.print(':');
+    if (zone.start % 60 < 10) frame.print('0');
+    frame.print(zone.start % 60);
+  } else if (nextZone == NO_ZONE) {
+    frame.printFlash(PSTR(" NX:off"));
+  } else {
+    int nextSprayMinute = (zone.start + zoneRuns[shown].nextSlot * zone.interval) % (24 * 60);
+    // With several zones the label names the zone instead: " Z2:14:00"
+    if (zoneCount > 1) {
+      frame.printFlash(PSTR(" Z"));
+      frame.print(shown + 1);
+      frame.print(':');
+    } else {
+      frame.printFlash(PSTR(" NX:"));
+    }
+    frame.print(nextSprayMinute / 60);
+    frame.print(':');
+    if (nextSprayMinute % 60 < 10) frame.print('0');
+    frame.print(nextSprayMinute % 60);
+  }
+
+  // Display schedule info at the bottom
+  frame.setCursor(0, 1);
+
+  // Show hours and minutes for the spray interval
+  frame.print(zone.interval / 60);
+  frame.print('h');
+  if (zone.interval % 60 > 0) {
+    frame.print(zone.interval % 60);
+    frame.print('m');
+  }
+  frame.print('-');
+  frame.print(zone.duration);
+  frame.print('m');
+  frame.printFlash(PSTR(" ET:"));
+  frame.print(zone.end / 60);
+  frame.print(':');
+  if (zone.end % 60 < 10) frame.print('0');
+  frame.print(zone.end % 60);
+}
+
+/**
+ * The function `checkIrrigation` queues every zone whose precomputed `nextSprayTime` has been
+ * reached. All zones are evaluated in one pass; outside of those moments a zone costs a single
+ * comparison. Firing is edge-triggered on the slot: the first pass at or after its start queues
+ * it, however late that pass is, and records its ID so no later pass can queue it again. The
+ * loop period does not change which runs happen, only how late they may start.
+ */
+void checkIrrigation() {
+  bool rescheduled = false;
+
+  for (uint8_t i = 0; i < zoneCount; i++) {
+    ZoneRun &run = zoneRuns[i];
+
+    // A queued or running zone is owned by updateIrrigation() until its run ends
+    if (run.state != RUN_IDLE) {
+      continue;
+    }
+
+    if (!zones[i].enabled || currentTime.unixtime < run.nextSprayTime) {
+      // Ensure irrigation is off outside the schedule
+      halSetValve(zones[i].pin, false);
+      continue;
+    }
+
+    // The slot under the cursor, unless the loop was away for longer than an
+    // interval and a later one has begun since
+    bool overtaken = currentTime.unixtime - run.nextSprayTime >= zones[i].interval * 60UL;
+    uint32_t sprayTime = overtaken ? previousSprayTime(i) : run.nextSprayTime;
+    uint32_t slot = slotId(zones[i], sprayTime);
+    if (slot != run.firedSlot) {
+      run.firedSlot = slot;
+      run.lastSprayTime = sprayTime;
+      run.runMinutes = zones[i].duration;
+      run.state = RUN_PENDING;
+    }
+    if (overtaken) {
+      calculateNextSprayTime(i);
+    } else {
+      advanceSlot(i);
+    }
+    rescheduled = true;
+  }
+
+  if (rescheduled) {
+    findNextZone();
+  }
+}
+
+/**
+ * The function `catchUpMissedRuns` looks for zones whose latest slot passed without a run: the slot
+ * is newer than the last completed run in the run log (by less than a day, so a zone that was off
+ * for longer does not count) and its own minute is over. Each zone costs a few comparisons; the
+ * zone then follows `catchUpPolicy`. Called at boot and when the menu closes.
+ */
+void catchUpMissedRuns() {
+  for (uint8_t i = 0; i < zoneCount; i++) {
+    ZoneRun &run = zoneRuns[i];
+    if (!zones[i].enabled || run.state != RUN_IDLE || run.doneSprayTime == 0) {
+      continue;
+    }
+
+    uint32_t slot = previousSprayTime(i);
+    if (slot <= run.doneSprayTime || slotId(zones[i], slot) == run.firedSlot || slot - run.doneSprayTime > 86400UL ||
+        currentTime.unixtime - slot < 60) {
+      continue;
+    }
+
+    // Handled either way; it is not looked at again
+    run.firedSlot = slotId(zones[i], slot);
+    run.lastSprayTime = slot;
+    int lateMinutes = (currentTime.unixtime - slot) / 60;
+    if (catchUpPolicy == CATCH_UP_SKIP || (catchUpPolicy == CATCH_UP_SHORTEN && lateMinutes >= zones[i].duration)) {
+      halLog(PSTR("Irrigation missed"));
+      continue;
+    }
+
+    // Queued like a slot that is due now; triggerIrrigation() clips it to the window
+    run.runMinutes = zones[i].duration - (catchUpPolicy == CATCH_UP_SHORTEN ? lateMinutes : 0);
+    run.state = RUN_PENDING;
+    halLog(PSTR("Irrigation catching up"));
+  }
+}
+
+/**
+ * The function `resetCatchUp` starts a zone's catch-up afresh after the menu changed its settings.
+ * Slots of the old schedule say nothing about the new one, so the edit becomes the zone's last
+ * completed run: only slots due after it can count as missed, also after a reboot, since it goes
+ * to the run log. The slot that fired last keeps its ID under the new schedule, so it cannot fire
+ * again.
+ */
+void resetCatchUp(uint8_t zone) {
+  ZoneRun &run = zoneRuns[zone];
+  run.doneSprayTime = currentTime.unixtime;
+  run.firedSlot = run.lastSprayTime != 0 ? slotId(zones[zone], run.lastSprayTime) : 0;
+  runLogSave(zone, currentTime.unixtime);
+}
+
+/**
+ * The function `triggerIrrigation` opens the valve of a queued zone and starts its alarm pulse.
+ * The run is clipped to the zone's spray window, counted from its slot, so time spent queued
+ * behind another zone comes off the run. Returns false if the window has already closed.
+ */
+bool triggerIrrigation(uint8_t zone) {
+  const Zone &settings = zones[zone];
+  ZoneRun &run = zoneRuns[zone];
+
+  // Calculate maximum duration to avoid running past end time
+  int maxDuration = slotWindowMinutes(settings, slotId(settings, run.lastSprayTime) & 0xFF);
+  maxDuration -= (currentTime.unixtime - run.lastSprayTime) / 60;
+  if (maxDuration <= 0) {
+    run.state = RUN_IDLE;
+    halLog(PSTR("Irrigation skipped"));
+    return false;
+  }
+
+  // Use the shorter of the queued run or remaining time until end
+  int actualDuration = run.runMinutes < maxDuration ? run.runMinutes : maxDuration;
+
+  halSetAlarm(true);
+  halSetValve(settings.pin, true);
+  halLog(PSTR("Irrigation ON"));
+
+  // The rest of the run is timed by updateIrrigation() from the loop
+  run.runMinutes = actualDuration;
+  run.state = RUN_ALARM;
+  run.stateStart = halMillis();
+  return true;
+}
+
+/**
+ * The function `updateIrrigation` advances every zone's run state machine by at most one step and
+ * starts queued zones as the run policy allows. It is called on every loop pass and never blocks,
+ * so the display and buttons stay live while valves are open.
+ */
+void updateIrrigation() {
+  uint8_t alarms = 0;       // Zones still pulsing the alarm
+  uint8_t openValves = 0;   // Zones holding their valve open
+  bool alarmEnded = false;
+
+  for (uint8_t i = 0; i < zoneCount; i++) {
+    ZoneRun &run = zoneRuns[i];
+    uint32_t elapsed = halMillis() - run.stateStart;
+
+    switch (run.state) {
+      case RUN_IDLE:
+      case RUN_PENDING:
+        break;
+
+      case RUN_ALARM:
+        // Keep the alarm on long enough to ensure the relay is triggered
+        if (elapsed >= alarmPulseDuration) {
+          alarmEnded = true;
+          run.state = RUN_VALVE_OPEN;
+          run.stateStart = halMillis();
+        }
+        break;
+
+      case RUN_VALVE_OPEN:
+        if (elapsed >= run.runMinutes * 60UL * 1000UL) {
+          run.state = RUN_CLOSING;
+        }
+        break;
+
+      case RUN_CLOSING:
+        halSetValve(zones[i].pin, false);
+        halLog(PSTR("Irrigation OFF"));
+        run.state = RUN_IDLE;
+        // Unless the menu changed the zone during the run, which already
+        // moved its last completed run past this one
+        if (run.lastSprayTime > run.doneSprayTime) {
+          run.doneSprayTime = run.lastSprayTime;
+          runLogSave(i, run.lastSprayTime);
+        }
+        // Slots that fell inside a long run are skipped
+        calculateNextSprayTime(i);
+        findNextZone();
+        break;
+    }
+
+    if (run.state == RUN_ALARM) alarms++;
+    if (run.state >= RUN_ALARM) openValves++;
+  }
+
+  // The alarm output is shared; release it once the last pulse is over
+  if (alarmEnded && alarms == 0) {
+    halSetAlarm(false);
+  }
+
+  // Start queued zones, in table order
+  for (uint8_t i = 0; i < zoneCount; i++) {
+    if (zoneRuns[i].state != RUN_PENDING) {
+      continue;
+    }
+    if (runPolicy == RUN_SEQUENTIAL && openValves > 0) {
+      break;
+    }
+    if (triggerIrrigation(i)) {
+      openValves++;
+    }
+  }
+}
+
+// Show a running zone and the minutes it has left
+void displayIrrigationStatus() {
+  // The first zone with an open valve, else the first queued one
+  uint8_t shown = NO_ZONE;
+  for (uint8_t i = 0; i < zoneCount && shown == NO_ZONE; i++) {
+    if (zoneRuns[i].state >= RUN_ALARM) shown = i;
+  }
+  for (uint8_t i = 0; i < zoneCount && shown == NO_ZONE; i++) {
+    if (zoneRuns[i].state == RUN_PENDING) shown = i;
+  }
+  if (shown == NO_ZONE) shown = 0;
+  const ZoneRun &run = zoneRuns[shown];
+
+  unsigned long runMillis = run.runMinutes * 60UL * 1000UL;
+  unsigned long remaining = runMillis;
+  if (run.state == RUN_VALVE_OPEN || run.state == RUN_CLOSING) {
+    uint32_t elapsed = halMillis() - run.stateStart;
+    remaining = elapsed < runMillis ? runMillis - elapsed : 0;
+  }
+
+  frame.clear();
+  frame.setCursor(0, 0);
+  frame.printFlash(PSTR("Irrigation ON"));
+  if (zoneCount > 1) {
+    frame.printFlash(PSTR(" Z"));
+    frame.print(shown + 1);
+  }
+  frame.setCursor(0, 1);
+  frame.printFlash(PSTR("For: "));
+  frame.print((remaining + 59999UL) / 60000UL);  // Round up to whole minutes
+  frame.print('/');
+  frame.print(run.runMinutes);
+  frame.printFlash(PSTR("min"));
+}
@@ -0,0 +1,135 @@
+#ifndef Irrigation_h
+#define Irrigation_h
+
+#include "IrrigationHal.h"
+#include "Journal.h"
+#include "RunLog.h"
+
+// Zones the core can drive. Every zone costs sizeof(Zone) bytes of storage and
+// sizeof(Zone) + sizeof(ZoneRun) bytes of RAM whether the board wires it or
+// not, so the firmware takes the count from its board profile (BoardZones.h);
+// host builds set it with -D MAX_ZONES=n.
+#ifndef MAX_ZONES
+#include <BoardZones.h>
+#endif
+
+// One valve and its schedule, exactly as kept in storage
+struct Zone {
+  uint8_t pin : 7;          // Valve output pin
+  uint8_t enabled : 1;
+  uint8_t duration;         // Spray duration in minutes (1..120)
+  uint16_t interval;        // Spray interval in minutes (30..1440)
+  uint16_t start;           // Start of the spray window, minutes since midnight
+  uint16_t end;             // End of the window; at or before the start wraps past midnight
+};
+
+// Scheduler and run engine state of one zone; rebuilt at boot, never stored
+struct ZoneRun {
+  uint32_t nextSprayTime;   // Next spray start, as RTC unixtime
+  uint32_t lastSprayTime;   // Start of the last slot that fired, as RTC unixtime
+  uint32_t firedSlot;       // slotId() of that slot; no slot fires twice
+  uint32_t doneSprayTime;   // Slot of the last run that completed, kept in the run log
+  uint32_t stateStart;      // halMillis() when the current run state was entered
+  uint8_t nextSlot;         // Cursor: index of nextSprayTime among the window's slots
+  uint8_t slotCount;        // Slots per window, compiled from the settings
+  uint8_t runMinutes;       // Length of the queued run, then clipped to the window
+  uint8_t state;            // RunState
+};
+
+// Storage addresses. Firmware before the zone table kept one schedule as six
+// ints at 0..23; they are left alone and read to migrate it into zone 0 until
+// the journal holds a record.
+const int ADDR_SPRAY_MINUTES = 0;
+const int ADDR_SPRAY_DURATION = 4;
+const int ADDR_START_HOUR = 8;
+const int ADDR_START_MINUTE = 12;
+const int ADDR_END_HOUR = 16;
+const int ADDR_END_MINUTE = 20;
+const int ADDR_JOURNAL = 24;  // Settings journal (Journal.h) up to the run log
+// The run log (RunLog.h) takes the last RUN_LOG_SIZE bytes of storage
+const int JOURNAL_RECORD_SIZE = JOURNAL_HEADER_SIZE + MAX_ZONES * sizeof(Zone);
+
+// Storage budget, sized for the smallest target (ATmega168: 512 bytes of
+// EEPROM). RAM is checked on the linked firmware by scripts/firmware_footprint.py.
+static_assert(sizeof(Zone) == 8, "Zone must stay packed into 8 bytes");
+static_assert(ADDR_JOURNAL + 2 * JOURNAL_RECORD_SIZE + RUN_LOG_SIZE <= 512,
+              "Settings journal needs room for two records next to the run log");
+
+const uint8_t NO_ZONE = 0xFF;
+
+// Irrigation run engine, per zone:
+// idle -> pending (waiting for a free valve) -> alarm pulse -> valve open -> closing -> idle
+enum RunState { RUN_IDLE, RUN_PENDING, RUN_ALARM, RUN_VALVE_OPEN, RUN_CLOSING };
+
+// What a zone does about a slot that passed while the board was off, or
+// otherwise never started, when that is noticed at boot or on leaving the menu
+enum CatchUpPolicy {
+  CATCH_UP_SKIP,     // Log the missed run and wait for the next slot
+  CATCH_UP_LATE,     // Run the full duration now, within the spray window
+  CATCH_UP_SHORTEN   // Run only what is left of the run had it started on time
+};
+
+// How zones that are due at the same time share the water supply
+enum RunPolicy {
+  RUN_SEQUENTIAL,  // One valve open at a time; due zones queue in table order
+  RUN_PARALLEL     // Every due zone opens at once
+};
+
+// Zone table and schedule
+extern Zone zones[MAX_ZONES];
+extern ZoneRun zoneRuns[MAX_ZONES];
+extern uint8_t zoneCount;          // Zones wired on this board
+extern uint8_t nextZone;           // Enabled zone with the earliest next spray start, or NO_ZONE
+extern RunPolicy runPolicy;
+extern CatchUpPolicy catchUpPolicy;
+extern ClockTime currentTime;      // Time snapshot shared by everything in one loop pass
+
+enum MenuState { MAIN, MENU_LIST, SET_ZONE, SET_INTERVAL, SET_DURATION, SET_START_TIME, SET_END_TIME, EXIT_MENU };
+extern MenuState currentMenu;
+extern uint8_t editZone;           // Zone the menu editors work on
+
+enum  HourOrMinute { HOUR, MINUTE };
+enum IncreaseOrDecrease { INCREASE, DECREASE };
+enum TimeSetting { START, END };
+
+// Entry points for the platform's setup() and loop(). factoryZones holds one
+// entry per wired valve (at most MAX_ZONES); it seeds and validates the
+// stored table.
+void irrigationSetup(const Zone *factoryZones, uint8_t count);
+void irrigationLoop();
+
+// Settings
+void loadSettings(const Zone *factoryZones);
+void saveSettings();
+
+// Scheduler and run engine
+void calculateNextSprayTimes();
+void compileSchedule(uint8_t zone);
+void calculateNextSprayTime(uint8_t zone);
+void advanceSlot(uint8_t zone);
+uint32_t slotId(const Zone &settings, uint32_t sprayTime);
+uint32_t previousSprayTime(uint8_t zone);
+void findNextZone();
+void checkIrrigation();
+void catchUpMissedRuns();
+void resetCatchUp(uint8_t zone);
+bool triggerIrrigation(uint8_t zone);
+void updateIrrigation();
+bool irrigationBusy();
+
+// Screens
+void displayTimeAndSettings();
+void displayIrrigationStatus();
+uint32_t nextWakeTime();
+
+// Menu
+void openMenu(HalButton button);
+void closeMenu();
+void menuStep(const HalButtonEvent &event);
+void renderMenu();
+HalButtonEvent nextButtonEvent();
+bool isGesture(const HalButtonEvent &event, HalButton button, HalGesture gesture);
+bool isStep(const HalButtonEvent &event, HalButton button);
+void setHourOrMinute(HourOrMinute setting, TimeSetting time, IncreaseOrDecrease action);
+
+#endif
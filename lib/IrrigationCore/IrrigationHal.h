@@ -0,0 +1,70 @@
+#ifndef IrrigationHal_h
+#define IrrigationHal_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <LcdFrame.h>
+#include <FlashString.h>
+
+// Hardware abstraction used by the irrigation core.
+//
+// The core never touches Arduino APIs directly; each platform provides these
+// functions and the `frame` display buffer at link time. On the Nano they are
+// implemented in src/main.cpp, on host builds by the fakes in src/native/.
+
+// Broken-down time snapshot. unixtime counts RTC local time, so
+// unixtime % 86400 is the time of day.
+struct ClockTime {
+  uint32_t unixtime;
+  uint8_t hour;
+  uint8_t minute;
+  uint8_t second;
+};
+
+enum HalButton { BUTTON_MENU, BUTTON_SELECT, BUTTON_SWITCH };
+
+// Gestures the platform recognises from debounced presses
+enum HalGesture {
+  GESTURE_SHORT,   // Pressed and released quickly
+  GESTURE_LONG,    // Held for the long-press time (2 s); once per press
+  GESTURE_REPEAT,  // Still held: sent periodically, like a key repeat
+  GESTURE_DOUBLE,  // Two quick presses, on buttons the platform enables it for
+  GESTURE_NONE     // Nothing pressed; never sent by the platform
+};
+
+struct HalButtonEvent {
+  HalButton button;
+  HalGesture gesture;
+};
+
+// Clock
+unsigned long halMillis();
+void halDelay(unsigned long ms);
+// Time snapshot for the current loop pass
+ClockTime halNow();
+// End of a loop pass. wakeTime == 0 means the core is busy and wants the
+// next pass soon; otherwise nothing changes before that RTC unixtime unless
+// a button is pressed, and the platform may sleep until then.
+void halIdle(uint32_t wakeTime);
+
+// GPIO
+// Debounced button level
+bool halButtonDown(HalButton button);
+// Oldest button gesture not yet handled; false if there is none
+bool halButtonEvent(HalButtonEvent &event);
+void halSetAlarm(bool on);
+// Valve outputs are addressed by the pin in the zone table
+void halSetValve(uint8_t pin, bool on);
+
+// Display: screens render into this frame; flush() pushes it to the panel
+extern LcdFrame frame;
+
+// Persistent storage (EEPROM on the Nano). Writes skip unchanged bytes.
+size_t halStorageSize();
+void halStorageRead(int address, void *data, size_t size);
+void halStorageWrite(int address, const void *data, size_t size);
+
+// Diagnostics; message is a string in flash (PSTR())
+void halLog(const char *message);
+
+#endif
@@ -0,0 +1,110 @@
+#include "Irrigation.h"
+#include "Journal.h"
+
+// Never written as a sequence number, so an erased slot can't pass as a record
+const uint16_t JOURNAL_ERASED = 0xFFFF;
+
+int journalSlots = 0;              // Slots between ADDR_JOURNAL and the run log
+int journalNewest = -1;            // Slot of the newest valid record, -1 if none
+uint16_t journalSequence = 0;      // Sequence number of the newest record
+
+// CRC-16 (polynomial 0xA001, as avr-libc's _crc16_update)
+static uint16_t crc16Update(uint16_t crc, const uint8_t *bytes, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    crc ^= bytes[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+    }
+  }
+  return crc;
+}
+
+static int slotAddress(int slot, size_t size) {
+  return ADDR_JOURNAL + slot * (JOURNAL_HEADER_SIZE + size);
+}
+
+// CRC of the record stored at address, computed from storage in small chunks
+static uint16_t storedCrc(int address, uint16_t sequence, size_t size) {
+  uint8_t chunk[16];
+  uint16_t crc = crc16Update(0xFFFF, (const uint8_t *)&sequence, sizeof(sequence));
+  address += JOURNAL_HEADER_SIZE;
+  while (size > 0) {
+    size_t length = size < sizeof(chunk) ? size : sizeof(chunk);
+    halStorageRead(address, chunk, length);
+    crc = crc16Update(crc, chunk, length);
+    address += length;
+    size -= length;
+  }
+  return crc;
+}
+
+// True if the data stored at address matches bytes
+static bool storedEquals(int address, const uint8_t *bytes, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    uint8_t stored;
+    halStorageRead(address + i, &stored, 1);
+    if (stored != bytes[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * The function `journalLoad` scans every slot once, keeps the valid record with the highest
+ * sequence number (compared modulo 2^16, so the counter may wrap) and copies its data out.
+ */
+bool journalLoad(void *data, size_t size) {
+  journalSlots = (halStorageSize() - RUN_LOG_SIZE - ADDR_JOURNAL) / (JOURNAL_HEADER_SIZE + size);
+  journalNewest = -1;
+
+  for (int slot = 0; slot < journalSlots; slot++) {
+    int address = slotAddress(slot, size);
+    uint16_t header[2];  // Sequence number, CRC
+    halStorageRead(address, header, sizeof(header));
+    if (header[0] == JOURNAL_ERASED || storedCrc(address, header[0], size) != header[1]) {
+      continue;
+    }
+    if (journalNewest < 0 || (int16_t)(header[0] - journalSequence) > 0) {
+      journalNewest = slot;
+      journalSequence = header[0];
+    }
+  }
+
+  if (journalNewest < 0) {
+    return false;
+  }
+  halStorageRead(slotAddress(journalNewest, size) + JOURNAL_HEADER_SIZE, data, size);
+  return true;
+}
+
+/**
+ * The function `journalSave` appends a record in the slot after the newest one, which holds the
+ * oldest record. The data goes first, then the sequence number and the CRC, computed from RAM.
+ */
+void journalSave(const void *data, size_t size) {
+  const uint8_t *bytes = (const uint8_t *)data;
+  if (journalSlots == 0) {
+    return;
+  }
+
+  // Nothing changed since the last save (an editor left without edits)
+  if (journalNewest >= 0 && storedEquals(slotAddress(journalNewest, size) + JOURNAL_HEADER_SIZE, bytes, size)) {
+    return;
+  }
+
+  int slot = journalNewest + 1 < journalSlots ? journalNewest + 1 : 0;
+  uint16_t sequence = journalSequence + 1;
+  if (sequence == JOURNAL_ERASED) {
+    sequence = 0;
+  }
+  uint16_t crc = crc16Update(crc16Update(0xFFFF, (const uint8_t *)&sequence, sizeof(sequence)), bytes, size);
+
+  int address = slotAddress(slot, size);
+  halStorageWrite(address + JOURNAL_HEADER_SIZE, bytes, size);
+  halStorageWrite(address, &sequence, sizeof(sequence));
+  halStorageWrite(address + sizeof(sequence), &crc, sizeof(crc));
+
+  journalNewest = slot;
+  journalSequence = sequence;
+}
@@ -0,0 +1,34 @@
+#ifndef Journal_h
+#define Journal_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Append-only, wear-leveled settings journal in persistent storage.
+//
+// The storage from ADDR_JOURNAL to the run log (RunLog.h) is split into slots of
+// JOURNAL_HEADER_SIZE + size bytes. Every save goes to the slot after the
+// newest record, so the EEPROM wear is spread over all slots instead of
+// hammering fixed addresses. A record is
+//
+//   [sequence:2][crc16:2][data:size]
+//
+// with the CRC covering the sequence number and the data. The CRC is written
+// last: a save torn by a power cut leaves a record that fails the check, and
+// the previous one (in another slot) is still the newest valid record.
+//
+// Each journal holds records of one fixed size; always pass the same size.
+
+const int JOURNAL_HEADER_SIZE = 4;
+
+// Find the newest valid record in one pass over the slots and copy it into
+// data. Returns false (leaving data alone) if the journal holds no valid
+// record. Must run once before the first journalSave().
+bool journalLoad(void *data, size_t size);
+
+// Append data as a new record, unless it equals the newest one. Storage
+// writes skip unchanged bytes, so only the header and the bytes that differ
+// from the slot's previous record are actually written.
+void journalSave(const void *data, size_t size);
+
+#endif
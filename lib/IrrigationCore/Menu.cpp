@@ -0,0 +1,254 @@
+#include <string.h>
+#include "Irrigation.h"
+#include <FlashString.h>
+
+MenuState currentMenu = MAIN;
+uint8_t editZone = 0;
+Zone editing;                       // Copy of zones[editZone] the editors change; stored on exit
+HourOrMinute currentSetting = HOUR; // Field the start/end time editors adjust
+
+uint8_t selectedMenuIndex = 0;      // Row of menuScreens shown in the list or being edited
+int8_t heldButton = -1;             // Button whose long press changed the screen, until released
+
+// One row per menu entry. The list shows `label`; opening the entry shows
+// `title` with `render()` below it. In an editor Switch calls adjust(+1) and
+// Select adjust(-1) (short press or held), a short Menu press calls toggle()
+// if there is one, and a long Menu press stores the edit and goes back.
+struct MenuScreen {
+  MenuState state;
+  const char *label;           // In flash
+  const char *title;           // In flash
+  void (*render)();
+  void (*adjust)(int8_t step);
+  void (*toggle)();
+};
+
+static void printTime(uint16_t timeInMinutes) {
+  frame.print(timeInMinutes / 60);
+  frame.print(':');
+  if (timeInMinutes % 60 < 10) frame.print('0');
+  frame.print(timeInMinutes % 60);
+}
+
+// Zone: Switch/Select pick the zone, Menu switches it on or off
+static void renderZone() {
+  frame.printFlash(PSTR("Zone "));
+  frame.print(editZone + 1);
+  frame.printFlash(editing.enabled ? PSTR(" on") : PSTR(" off"));
+}
+
+// Put the edited copy back into the zone table. A zone whose settings
+// changed starts its catch-up afresh, and is saved and rescheduled at once,
+// also when the zone editor moves on to another zone
+static void storeEdit() {
+  if (memcmp(&zones[editZone], &editing, sizeof(Zone)) != 0) {
+    zones[editZone] = editing;
+    resetCatchUp(editZone);
+    saveSettings();
+    calculateNextSprayTimes();
+  }
+}
+
+static void adjustZone(int8_t step) {
+  storeEdit();
+  editZone = (editZone + zoneCount + step) % zoneCount;
+  editing = zones[editZone];
+}
+
+static void toggleZone() {
+  editing.enabled = !editing.enabled;
+}
+
+// Interval: 30-minute steps from 30 minutes to 24 hours, wrapping around
+static void renderInterval() {
+  frame.print(editing.interval / 60);
+  frame.printFlash(PSTR("h "));
+  frame.print(editing.interval % 60);
+  frame.print('m');
+}
+
+static void adjustInterval(int8_t step) {
+  int interval = editing.interval + step * 30;
+  if (interval > 1440) interval = 30;
+  if (interval < 30) interval = 1440;
+  editing.interval = interval;
+}
+
+// Duration: 1 to 120 minutes
+static void renderDuration() {
+  frame.print(editing.duration);
+  frame.printFlash(PSTR(" minutes"));
+}
+
+static void adjustDuration(int8_t step) {
+  int duration = editing.duration + step;
+  if (duration < 1) duration = 1;
+  if (duration > 120) duration = 120;
+  editing.duration = duration;
+}
+
+// Start and end time: Menu switches between the hour and the minute
+static void renderStartTime() {
+  printTime(editing.start);
+  frame.printFlash(currentSetting == HOUR ? PSTR(" hour") : PSTR(" minute"));
+}
+
+static void adjustStartTime(int8_t step) {
+  setHourOrMinute(currentSetting, START, step > 0 ? INCREASE : DECREASE);
+}
+
+static void renderEndTime() {
+  printTime(editing.end);
+  frame.printFlash(currentSetting == HOUR ? PSTR(" hour") : PSTR(" minute"));
+}
+
+static void adjustEndTime(int8_t step) {
+  setHourOrMinute(currentSetting, END, step > 0 ? INCREASE : DECREASE);
+}
+
+static void toggleTimeField() {
+  currentSetting = currentSetting == HOUR ? MINUTE : HOUR;
+}
+
+const char labelZone[] PROGMEM = "Set Zone";
+const char titleZone[] PROGMEM = "Set Zone:";
+const char labelInterval[] PROGMEM = "Set Interval";
+const char titleInterval[] PROGMEM = "Set Interval:";
+const char labelDuration[] PROGMEM = "Set Duration";
+const char titleDuration[] PROGMEM = "Set Duration:";
+const char labelStartTime[] PROGMEM = "Set Start Time";
+const char titleStartTime[] PROGMEM = "Set Start Time:";
+const char labelEndTime[] PROGMEM = "Set End Time";
+const char titleEndTime[] PROGMEM = "Set End Time:";
+const char labelExit[] PROGMEM = "Exit";
+
+const MenuScreen menuScreens[] PROGMEM = {
+  { SET_ZONE, labelZone, titleZone, renderZone, adjustZone, toggleZone },
+  { SET_INTERVAL, labelInterval, titleInterval, renderInterval, adjustInterval, 0 },
+  { SET_DURATION, labelDuration, titleDuration, renderDuration, adjustDuration, 0 },
+  { SET_START_TIME, labelStartTime, titleStartTime, renderStartTime, adjustStartTime, toggleTimeField },
+  { SET_END_TIME, labelEndTime, titleEndTime, renderEndTime, adjustEndTime, toggleTimeField },
+  { EXIT_MENU, labelExit, 0, 0, 0, 0 },
+};
+const uint8_t maxMenuItems = sizeof(menuScreens) / sizeof(menuScreens[0]);
+
+static void loadScreen(MenuScreen &screen) {
+  memcpy_P(&screen, &menuScreens[selectedMenuIndex], sizeof(screen));
+}
+
+void openMenu(HalButton button) {
+  currentMenu = MENU_LIST;
+  selectedMenuIndex = 0;
+  heldButton = button;
+}
+
+void closeMenu() {
+  currentMenu = MAIN;
+  // A slot may have been missed while the menu was open; edited zones only
+  // count the slots due after the edit
+  catchUpMissedRuns();
+}
+
+/**
+ * The function `menuStep` applies one button gesture to the menu and returns. It is called once
+ * per loop pass while the menu is open, so the scheduler and the run engine keep running while
+ * someone edits settings.
+ */
+void menuStep(const HalButtonEvent &event) {
+  if (event.gesture == GESTURE_NONE) {
+    return;
+  }
+
+  // Repeats from the long press that opened this screen are not meant for it
+  if (heldButton >= 0) {
+    if (halButtonDown((HalButton)heldButton) && event.button == heldButton) {
+      return;
+    }
+    heldButton = -1;
+  }
+
+  MenuScreen screen;
+  loadScreen(screen);
+
+  if (currentMenu == MENU_LIST) {
+    if (isGesture(event, BUTTON_MENU, GESTURE_SHORT)) {
+      // Short press navigates between menu items
+      selectedMenuIndex = (selectedMenuIndex + 1) % maxMenuItems;
+    } else if (isGesture(event, BUTTON_SELECT, GESTURE_LONG)) {
+      // Long press selects the current menu item
+      heldButton = BUTTON_SELECT;
+      if (screen.state == EXIT_MENU) {
+        closeMenu();
+      } else {
+        editing = zones[editZone];
+        currentSetting = HOUR;
+        currentMenu = screen.state;
+      }
+    } else if (isGesture(event, BUTTON_MENU, GESTURE_LONG)) {
+      closeMenu();
+    }
+    return;
+  }
+
+  if (isStep(event, BUTTON_SWITCH)) {
+    screen.adjust(1);
+  } else if (isStep(event, BUTTON_SELECT)) {
+    screen.adjust(-1);
+  } else if (isGesture(event, BUTTON_MENU, GESTURE_SHORT) && screen.toggle) {
+    screen.toggle();
+  } else if (isGesture(event, BUTTON_MENU, GESTURE_LONG)) {
+    // Store the edit and go back to the list
+    heldButton = BUTTON_MENU;
+    storeEdit();
+    currentMenu = MENU_LIST;
+  }
+}
+
+// Draw the open menu screen into the frame
+void renderMenu() {
+  MenuScreen screen;
+  loadScreen(screen);
+
+  frame.clear();
+  frame.setCursor(0, 0);
+  if (currentMenu == MENU_LIST) {
+    frame.printFlash(PSTR("> "));
+    frame.printFlash(screen.label);
+    return;
+  }
+  frame.printFlash(screen.title);
+  frame.setCursor(0, 1);
+  screen.render();
+}
+
+// The button gesture waiting for this loop pass, if any
+HalButtonEvent nextButtonEvent() {
+  HalButtonEvent event;
+  if (!halButtonEvent(event)) {
+    event.button = BUTTON_MENU;
+    event.gesture = GESTURE_NONE;
+  }
+  return event;
+}
+
+bool isGesture(const HalButtonEvent &event, HalButton button, HalGesture gesture) {
+  return event.gesture == gesture && event.button == button;
+}
+
+// A short press steps a value once; holding the button keeps stepping it
+bool isStep(const HalButtonEvent &event, HalButton button) {
+  return isGesture(event, button, GESTURE_SHORT) || isGesture(event, button, GESTURE_REPEAT);
+}
+
+// Step the hour or the minute of the edited zone's start or end time
+void setHourOrMinute(HourOrMinute setting, TimeSetting timeSetting, IncreaseOrDecrease action)
+ {
+  uint16_t &timeInMinutes = timeSetting == START ? editing.start : editing.end;
+
+  // Hours wrap at midnight and keep the minute; minutes carry into the hour
+  int step = setting == HOUR ? 60 : 1;
+  if (action == DECREASE) {
+    step = 24 * 60 - step;
+  }
+  timeInMinutes = (timeInMinutes + step) % (24 * 60);
+}
@@ -0,0 +1,82 @@
+#include <string.h>
+#include "Irrigation.h"
+#include "RunLog.h"
+
+// Never written as a sequence number, so an erased record can't pass as one
+const uint16_t RUN_LOG_ERASED = 0xFFFF;
+
+// Records in each zone's ring; two at least, so a torn append leaves the
+// previous one
+const int RUN_LOG_ZONE_RECORDS = RUN_LOG_RECORDS / MAX_ZONES;
+static_assert(RUN_LOG_ZONE_RECORDS >= 2, "The run log needs two records per zone; raise RUN_LOG_RECORDS");
+
+int8_t runLogNewest[MAX_ZONES];    // Index of each zone's newest valid record, -1 if none
+uint16_t runLogSequence[MAX_ZONES]; // Sequence number of each zone's newest record
+
+struct RunRecord {
+  uint16_t sequence;
+  uint32_t sprayTime;
+  uint8_t zone;
+  uint8_t crc;
+} __attribute__((packed));
+
+static_assert(sizeof(RunRecord) == RUN_LOG_RECORD_SIZE, "RunRecord must match RUN_LOG_RECORD_SIZE");
+
+// CRC-8 (polynomial 0x8C, as avr-libc's _crc_ibutton_update)
+static uint8_t crc8(const uint8_t *bytes, size_t size) {
+  uint8_t crc = 0;
+  for (size_t i = 0; i < size; i++) {
+    crc ^= bytes[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0x8C : crc >> 1;
+    }
+  }
+  return crc;
+}
+
+static int recordAddress(uint8_t zone, int index) {
+  return halStorageSize() - RUN_LOG_SIZE + (zone * RUN_LOG_ZONE_RECORDS + index) * RUN_LOG_RECORD_SIZE;
+}
+
+static bool readRecord(uint8_t zone, int index, RunRecord &record) {
+  halStorageRead(recordAddress(zone, index), &record, sizeof(record));
+  return record.sequence != RUN_LOG_ERASED && record.zone == zone &&
+         record.crc == crc8((const uint8_t *)&record, sizeof(record) - 1);
+}
+
+/**
+ * The function `runLogLoad` finds the newest valid record in each zone's ring (sequence numbers
+ * compared modulo 2^16; a ring only ever holds consecutive appends of its zone).
+ */
+void runLogLoad(uint32_t *completed, uint8_t count, uint32_t now) {
+  RunRecord record;
+  memset(runLogNewest, -1, sizeof(runLogNewest));
+  memset(completed, 0, count * sizeof(uint32_t));
+  for (uint8_t zone = 0; zone < count; zone++) {
+    for (int i = 0; i < RUN_LOG_ZONE_RECORDS; i++) {
+      if (readRecord(zone, i, record) &&
+          (runLogNewest[zone] < 0 || (int16_t)(record.sequence - runLogSequence[zone]) > 0)) {
+        runLogNewest[zone] = i;
+        runLogSequence[zone] = record.sequence;
+        completed[zone] = record.sprayTime <= now ? record.sprayTime : 0;
+      }
+    }
+  }
+}
+
+void runLogSave(uint8_t zone, uint32_t sprayTime) {
+  RunRecord record;
+  record.sequence = runLogSequence[zone] + 1;
+  if (record.sequence == RUN_LOG_ERASED) {
+    record.sequence = 0;
+  }
+  record.sprayTime = sprayTime;
+  record.zone = zone;
+  record.crc = crc8((const uint8_t *)&record, sizeof(record) - 1);
+
+  runLogNewest[zone] = (runLogNewest[zone] + 1) % RUN_LOG_ZONE_RECORDS;
+  runLogSequence[zone] = record.sequence;
+  int address = recordAddress(zone, runLogNewest[zone]);
+  halStorageWrite(address, &record, sizeof(record) - 1);
+  halStorageWrite(address + sizeof(record) - 1, &record.crc, 1);
+}
@@ -0,0 +1,34 @@
+#ifndef RunLog_h
+#define RunLog_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Completed runs at the end of persistent storage.
+//
+// Every run that finishes appends one record naming the zone and the slot it
+// ran for, so after a reset, a brown-out or a power cut the core knows the
+// last run each zone completed. The records are split evenly between the
+// zones, each zone appending round its own ring, so a busy zone never
+// overwrites the last run of one that waters once a day, and each zone's
+// EEPROM wear is spread over its share. A record is
+//
+//   [sequence:2][sprayTime:4][zone:1][crc8:1]
+//
+// with the CRC written last, so a torn append fails the check and the zone
+// keeps its previous record.
+
+const int RUN_LOG_RECORDS = 16;
+const int RUN_LOG_RECORD_SIZE = 8;
+const int RUN_LOG_SIZE = RUN_LOG_RECORDS * RUN_LOG_RECORD_SIZE;
+
+// Scan the rings once and set completed[zone] to the slot of the newest run
+// each of the first count zones completed, 0 if none (or if it lies after
+// now, the clock having been set back). Must run once before the first
+// runLogSave().
+void runLogLoad(uint32_t *completed, uint8_t count, uint32_t now);
+
+// Append the run of zone for the slot starting at sprayTime
+void runLogSave(uint8_t zone, uint32_t sprayTime);
+
+#endif
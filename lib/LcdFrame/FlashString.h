@@ -0,0 +1,19 @@
+#ifndef FlashString_h
+#define FlashString_h
+
+// Constant tables and strings that live in flash on the AVR (PROGMEM, PSTR())
+// and are read back with pgm_read_*/memcpy_P. A plain string literal is copied
+// into RAM at startup, so anything printed goes through PSTR(). Host builds
+// have one address space, so the same code reads ordinary const data.
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#else
+#include <stdint.h>
+#include <string.h>
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#define memcpy_P memcpy
+#endif
+
+#endif
@@ -0,0 +1,116 @@
+#include "LcdFrame.h"
+#include "FlashString.h"
+
+LcdFrame::LcdFrame(LcdSink &lcd) : _lcd(lcd), _col(0), _row(0), _valid(false) {
+  memset(_back, ' ', sizeof(_back));
+  memset(_front, ' ', sizeof(_front));
+}
+
+void LcdFrame::clear() {
+  memset(_back, ' ', sizeof(_back));
+  _col = 0;
+  _row = 0;
+}
+
+void LcdFrame::setCursor(uint8_t col, uint8_t row) {
+  _col = col;
+  _row = row < LCD_FRAME_ROWS ? row : LCD_FRAME_ROWS - 1;
+}
+
+void LcdFrame::write(char c) {
+  // Characters past the right edge land in invisible DDRAM on the real
+  // display, so they are simply dropped here
+  if (_col < LCD_FRAME_COLS) {
+    _back[_row][_col] = c;
+  }
+  if (_col < 0xFF) {
+    _col++;
+  }
+}
+
+void LcdFrame::print(const char *str) {
+  while (*str) {
+    write(*str++);
+  }
+}
+
+void LcdFrame::printFlash(const char *str) {
+  char c;
+  while ((c = pgm_read_byte(str++)) != '\0') {
+    write(c);
+  }
+}
+
+void LcdFrame::print(char c) {
+  write(c);
+}
+
+void LcdFrame::print(int value) {
+  print((long)value);
+}
+
+void LcdFrame::print(unsigned int value) {
+  printNumber(value, false);
+}
+
+void LcdFrame::print(long value) {
+  if (value < 0) {
+    printNumber(-(unsigned long)value, true);
+  } else {
+    printNumber(value, false);
+  }
+}
+
+void LcdFrame::print(unsigned long value) {
+  printNumber(value, false);
+}
+
+void LcdFrame::printNumber(unsigned long value, bool negative) {
+  char buf[11];
+  uint8_t len = 0;
+  do {
+    buf[len++] = '0' + value % 10;
+    value /= 10;
+  } while (value > 0);
+
+  if (negative) {
+    write('-');
+  }
+  while (len > 0) {
+    write(buf[--len]);
+  }
+}
+
+void LcdFrame::flush() {
+  for (uint8_t row = 0; row < LCD_FRAME_ROWS; row++) {
+    uint8_t col = 0;
+    while (col < LCD_FRAME_COLS) {
+      if (_valid && _back[row][col] == _front[row][col]) {
+        col++;
+        continue;
+      }
+
+      // Extend the run of changed cells. A single unchanged cell between two
+      // changes is cheaper to resend than a second cursor command.
+      uint8_t end = col + 1;
+      while (end < LCD_FRAME_COLS) {
+        if (!_valid || _back[row][end] != _front[row][end]) {
+          end++;
+        } else if (end + 1 < LCD_FRAME_COLS && _back[row][end + 1] != _front[row][end + 1]) {
+          end += 2;
+        } else {
+          break;
+        }
+      }
+
+      _lcd.writeAt(col, row, (const uint8_t *)&_back[row][col], end - col);
+      memcpy(&_front[row][col], &_back[row][col], end - col);
+      col = end;
+    }
+  }
+  _valid = true;
+}
+
+void LcdFrame::invalidate() {
+  _valid = false;
+}
@@ -0,0 +1,51 @@
+#ifndef LcdFrame_h
+#define LcdFrame_h
+
+#include <stdint.h>
+#include <string.h>
+#include "LcdSink.h"
+
+#define LCD_FRAME_COLS 16
+#define LCD_FRAME_ROWS 2
+
+// RAM shadow of a 16x2 character LCD.
+//
+// Screens are rendered into a back buffer with the usual clear/setCursor/print
+// calls; nothing is sent to the display until flush(), which compares the back
+// buffer against what is already on the glass and only transmits the cells
+// that changed, each changed run as a single LcdSink::writeAt() call.
+// Redrawing an unchanged screen therefore costs no I2C traffic, and since the
+// display is never cleared there is no flicker.
+class LcdFrame {
+public:
+  LcdFrame(LcdSink &lcd);
+
+  void clear();
+  void setCursor(uint8_t col, uint8_t row);
+  void write(char c);
+  void print(const char *str);
+  // Print a string stored in flash (PROGMEM, see FlashString.h)
+  void printFlash(const char *str);
+  void print(char c);
+  void print(int value);
+  void print(unsigned int value);
+  void print(long value);
+  void print(unsigned long value);
+
+  // Send the cells that differ from the last flushed frame
+  void flush();
+  // Forget what is on the display so the next flush() redraws every cell
+  void invalidate();
+
+private:
+  void printNumber(unsigned long value, bool negative);
+
+  LcdSink &_lcd;
+  char _back[LCD_FRAME_ROWS][LCD_FRAME_COLS];
+  char _front[LCD_FRAME_ROWS][LCD_FRAME_COLS];
+  uint8_t _col;
+  uint8_t _row;
+  bool _valid;
+};
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef LcdSink_h
+#define LcdSink_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Output side of an LcdFrame: something that can place a run of characters
+// at a given cell. Implemented by BatchedLcd, which host builds run against a
+// virtual panel.
+class LcdSink {
+public:
+  virtual void writeAt(uint8_t col, uint8_t row, const uint8_t *buffer, size_t size) = 0;
+
+protected:
+  // Sinks are never deleted through this interface; keeping the destructor
+  // out of the vtable saves the AVR a deleting destructor
+  ~LcdSink() {}
+};
+
+#endif
@@ -0,0 +1,35 @@
+#include "PinChange.h"
+#include <avr/interrupt.h>
+
+static volatile PinChangeHandler pinChangeHandler = 0;
+
+ISR(PCINT0_vect) {
+  PinChangeHandler handler = pinChangeHandler;
+  if (handler) {
+    handler();
+  }
+}
+ISR(PCINT1_vect, ISR_ALIASOF(PCINT0_vect));
+ISR(PCINT2_vect, ISR_ALIASOF(PCINT0_vect));
+
+void pinChangeEnable(uint8_t pin, bool enable) {
+  volatile uint8_t *pcmsk = digitalPinToPCMSK(pin);
+  if (pcmsk == 0) {
+    return;
+  }
+  uint8_t oldSREG = SREG;
+  cli();
+  if (enable) {
+    *pcmsk |= bit(digitalPinToPCMSKbit(pin));
+    PCIFR = bit(digitalPinToPCICRbit(pin));
+    *digitalPinToPCICR(pin) |= bit(digitalPinToPCICRbit(pin));
+  } else {
+    // The group stays enabled in PCICR; other pins in it may still be in use
+    *pcmsk &= ~bit(digitalPinToPCMSKbit(pin));
+  }
+  SREG = oldSREG;
+}
+
+void pinChangeSetHandler(PinChangeHandler handler) {
+  pinChangeHandler = handler;
+}
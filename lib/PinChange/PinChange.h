@@ -0,0 +1,17 @@
+#ifndef PinChange_h
+#define PinChange_h
+
+#include <Arduino.h>
+
+// Shared owner of the PCINT0..2 vectors.
+//
+// An enabled pin-change interrupt without a vector resets the AVR, and only one
+// library can define each vector, so every library that uses pin changes goes
+// through here. All three vectors call the one installed handler; with none
+// installed they only wake the CPU.
+typedef void (*PinChangeHandler)();
+
+void pinChangeEnable(uint8_t pin, bool enable);
+void pinChangeSetHandler(PinChangeHandler handler);
+
+#endif
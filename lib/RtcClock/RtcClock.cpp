@@ -0,0 +1,165 @@
+#include "RtcClock.h"
+
+const uint8_t DS3231_I2C_ADDRESS = 0x68;
+
+// Register pointer written before reading the time
+static const uint8_t timeRegister = 0x00;
+// Seconds, minutes and hours; the date follows in registers 0x03-0x06, then
+// the alarms, control, status, aging offset and temperature up to 0x12
+const uint8_t TIME_OF_DAY_REGISTERS = 3;
+const uint8_t SNAPSHOT_REGISTERS = 19;
+
+RtcClock::RtcClock(RTC_DS3231 &rtc)
+  : _rtc(rtc), _nowBuiltFor(0), _nowUnix(0), _dayStart(0), _lastReadUnix(0), _lastReadMillis(0), _resyncMillis(1000),
+    _sqwPin(-1), _sqwLevel(HIGH), _stale(true), _reading(false), _snapshotDue(false),
+    _readDoneMillis(0) {
+  _read.address = DS3231_I2C_ADDRESS;
+  _read.writeData = &timeRegister;
+  _read.writeLength = 1;
+  _read.readData = _registers;
+  _read.readLength = TIME_OF_DAY_REGISTERS;
+  _read.done = readDone;
+  _read.context = this;
+  _read.status = TWI_OK;
+}
+
+void RtcClock::begin(int8_t sqwPin, unsigned long resyncMillis) {
+  _sqwPin = sqwPin;
+  // Never poll the DS3231 more than once per second
+  _resyncMillis = resyncMillis < 1000 ? 1000 : resyncMillis;
+
+  if (_sqwPin >= 0) {
+    _rtc.writeSqwPinMode(DS3231_SquareWave1Hz);
+    pinMode(_sqwPin, INPUT_PULLUP);
+    _sqwLevel = digitalRead(_sqwPin);
+    // Edges are the primary trigger; only fall back to polling if they stop
+    _resyncMillis *= 2;
+  }
+
+  read();
+}
+
+void RtcClock::tick() {
+  if (_stale) {
+    read();
+    return;
+  }
+
+  // Pick up the read submitted on an earlier pass
+  if (_reading && _read.status != TWI_PENDING) {
+    _reading = false;
+    if (_read.status == TWI_OK) {
+      if (_read.readLength == SNAPSHOT_REGISTERS) {
+        applySnapshot();
+        applyTime(true);
+      } else {
+        applyTime(false);
+      }
+    }
+  }
+
+  unsigned long sinceRead = millis() - _lastReadMillis;
+  bool due = sinceRead >= _resyncMillis;
+
+  if (_sqwPin >= 0) {
+    // The DS3231 advances its seconds register on the falling edge of SQW
+    uint8_t level = digitalRead(_sqwPin);
+    if (_sqwLevel == HIGH && level == LOW) {
+      due = true;
+    }
+    _sqwLevel = level;
+  }
+
+  if (due && !_reading) {
+    _read.readLength = _snapshotDue ? SNAPSHOT_REGISTERS : TIME_OF_DAY_REGISTERS;
+    _snapshotDue = false;
+    twiQueue.submit(_read);
+    _reading = true;
+  }
+
+  _nowUnix = _lastReadUnix + sinceRead / 1000;
+  // Interpolated past midnight; the next read confirms it
+  if (_nowUnix - _dayStart >= 86400UL) {
+    _dayStart += 86400UL;
+  }
+}
+
+void RtcClock::resync() {
+  _stale = true;
+}
+
+const DateTime &RtcClock::now() {
+  if (_nowBuiltFor != _nowUnix) {
+    _now = DateTime(_nowUnix);
+    _nowBuiltFor = _nowUnix;
+  }
+  return _now;
+}
+
+int32_t RtcClock::readSecondOfDay() {
+  twiQueue.wait(_read);
+  _reading = false;
+  _read.readLength = TIME_OF_DAY_REGISTERS;
+  if (twiQueue.transfer(_read) != TWI_OK) {
+    return -1;
+  }
+  applyTime(false);
+  return _lastReadUnix - _dayStart;
+}
+
+// Read all registers and wait for the result
+void RtcClock::read() {
+  twiQueue.wait(_read);
+  _reading = false;
+  _read.readLength = SNAPSHOT_REGISTERS;
+  if (twiQueue.transfer(_read) == TWI_OK) {
+    applySnapshot();
+    applyTime(true);
+    _stale = false;
+  }
+}
+
+static uint8_t bcdToBinary(uint8_t value) {
+  return value - 6 * (value >> 4);
+}
+
+void RtcSnapshot::decode(const uint8_t *registers) {
+  time = DateTime(2000 + bcdToBinary(registers[6]), bcdToBinary(registers[5] & 0x7F), bcdToBinary(registers[4]),
+                  bcdToBinary(registers[2] & 0x3F), bcdToBinary(registers[1]), bcdToBinary(registers[0] & 0x7F));
+  control = registers[0x0E];
+  status = registers[0x0F];
+  agingOffset = registers[0x10];
+  // Two's complement whole degrees, then the quarters in the top two bits
+  temperature = (int8_t)registers[0x11] * 4 + (registers[0x12] >> 6);
+}
+
+// Decode the registers of a full read and take the date from them
+void RtcClock::applySnapshot() {
+  _snapshot.decode(_registers);
+  _dayStart = _snapshot.time.unixtime() - _snapshot.time.hour() * 3600UL - _snapshot.time.minute() * 60 -
+              _snapshot.time.second();
+}
+
+// Take the time of day from the registers of a finished read (24-hour mode).
+// After a time-only read the date is the one in _dayStart, unless the read
+// and the interpolated time are on opposite sides of midnight.
+void RtcClock::applyTime(bool withDate) {
+  uint32_t secondOfDay = bcdToBinary(_registers[2] & 0x3F) * 3600UL + bcdToBinary(_registers[1]) * 60 +
+                         bcdToBinary(_registers[0] & 0x7F);
+  if (!withDate) {
+    uint32_t readUnix = _dayStart + secondOfDay;
+    if (readUnix + 43200UL < _nowUnix) {
+      _dayStart += 86400UL;
+    } else if (readUnix > _nowUnix + 43200UL) {
+      _dayStart -= 86400UL;
+    }
+  }
+  _lastReadMillis = _readDoneMillis;
+  _lastReadUnix = _dayStart + secondOfDay;
+  _nowUnix = _lastReadUnix;
+}
+
+// Runs from the TWI interrupt the moment the registers are in
+void RtcClock::readDone(TwiTransaction &transaction) {
+  ((RtcClock *)transaction.context)->_readDoneMillis = millis();
+}
@@ -0,0 +1,102 @@
+#ifndef RtcClock_h
+#define RtcClock_h
+
+#include <Arduino.h>
+#include <RTClib.h>
+#include <TwiQueue.h>
+
+// DS3231 registers 0x00-0x12, the time, alarms, control, status, aging
+// offset and temperature, decoded from one read
+struct RtcSnapshot {
+  DateTime time;
+  uint8_t control;           // Register 0x0E
+  uint8_t status;            // Register 0x0F
+  int8_t agingOffset;
+  int16_t temperature;       // Quarter degrees Celsius, updated by the DS3231 every 64 s
+
+  void decode(const uint8_t *registers);
+
+  // OSF: the oscillator stopped since the flag was last cleared (rtc.adjust())
+  bool lostPower() const { return status & 0x80; }
+  // alarm is 1 or 2
+  bool alarmFired(uint8_t alarm) const { return status & alarm; }
+  float celsius() const { return temperature * 0.25; }
+};
+
+// Cached view of the DS3231 time.
+//
+// tick() is called once per loop() pass and reads the RTC at most once per
+// second, either on the falling edge of the DS3231 1 Hz square wave (when its
+// SQW pin is wired to the MCU) or when the resync period has elapsed. Between
+// reads the time is interpolated from millis(). Every consumer in a loop pass
+// then works from the same now() snapshot, so the display and the scheduler
+// cannot disagree about the current minute.
+//
+// The periodic reads go through the TWI queue: tick() submits the register
+// read and keeps interpolating, and a later tick() picks up the result, timed
+// from the moment the transfer finished. Only the first read and the one
+// after resync() wait for the bus, since nothing can be interpolated then.
+//
+// Only those two read the whole date. The periodic reads fetch just the
+// seconds, minutes and hours registers (3 bytes instead of 7) and carry the
+// date over from the last full read, rolling it at midnight. Callers that only
+// need the time of day use secondOfDay()/minuteOfDay(), which never build a
+// DateTime; now() builds one on demand.
+//
+// A full read takes all 19 registers in the same single transfer and also
+// refreshes snapshot(), so the power-loss flag, the alarm flags and the
+// temperature never cost a transaction of their own. requestSnapshot() makes
+// the next periodic read a full one.
+class RtcClock {
+public:
+  RtcClock(RTC_DS3231 &rtc);
+
+  // sqwPin < 0 uses millis() interpolation only; resyncMillis is how often
+  // the RTC is re-read in that mode (and the fallback if SQW edges stop)
+  void begin(int8_t sqwPin = -1, unsigned long resyncMillis = 1000);
+  void tick();
+  // Re-read the RTC on the next tick(), e.g. after rtc.adjust()
+  void resync();
+
+  const DateTime &now();
+  // The same snapshot as seconds since 1970, cheap to compare against
+  uint32_t unixtime() const { return _nowUnix; }
+  // The same snapshot as the time of day
+  uint32_t secondOfDay() const { return _nowUnix - _dayStart; }
+  uint16_t minuteOfDay() const { return secondOfDay() / 60; }
+
+  // Read the seconds, minutes and hours registers straight away, waiting for
+  // the bus; returns the second of the day, or -1 if the RTC did not answer
+  int32_t readSecondOfDay();
+
+  // Status and temperature as of the last full read
+  const RtcSnapshot &snapshot() const { return _snapshot; }
+  // Take the next periodic read as a full snapshot
+  void requestSnapshot() { _snapshotDue = true; }
+
+private:
+  void read();
+  void applySnapshot();
+  void applyTime(bool withDate);
+  static void readDone(TwiTransaction &transaction);
+
+  RTC_DS3231 &_rtc;
+  DateTime _now;                  // Built by now() for _nowBuiltFor
+  uint32_t _nowBuiltFor;
+  uint32_t _nowUnix;
+  uint32_t _dayStart;             // Unixtime of the last midnight
+  uint32_t _lastReadUnix;
+  unsigned long _lastReadMillis;
+  unsigned long _resyncMillis;
+  int8_t _sqwPin;
+  uint8_t _sqwLevel;
+  bool _stale;
+  bool _reading;                  // _read submitted and not picked up yet
+  bool _snapshotDue;
+  TwiTransaction _read;           // Registers from 0x00, the time of day or all of them
+  uint8_t _registers[19];
+  RtcSnapshot _snapshot;
+  volatile unsigned long _readDoneMillis;
+};
+
+#endif
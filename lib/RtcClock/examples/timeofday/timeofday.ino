@@ -0,0 +1,62 @@
+// Compares reading the time of day with RTClib's RTC_DS3231::now() against
+// RtcClock's three-register read, and times RtcClock::tick() as the loop
+// calls it.
+
+#include <Wire.h>
+#include <RTClib.h>
+#include <RtcClock.h>
+
+const int ROUNDS = 100;
+
+RTC_DS3231 rtc;
+RtcClock rtcClock(rtc);
+
+volatile uint16_t sink;
+
+void report(const char *name, unsigned long us, int busBytes) {
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print(us);
+  Serial.print(" us (");
+  Serial.print(us * (F_CPU / 1000000UL));
+  Serial.print(" cycles)");
+  if (busBytes > 0) {
+    Serial.print(", ");
+    Serial.print(busBytes);
+    Serial.print(" bytes on the bus");
+  }
+  Serial.println();
+}
+
+void setup() {
+  Serial.begin(9600);
+  rtc.begin();
+  rtcClock.begin();
+
+  // Address+W, register pointer, address+R, then 7 registers
+  unsigned long start = micros();
+  for (int i = 0; i < ROUNDS; i++) {
+    DateTime now = rtc.now();
+    sink = now.hour() * 60 + now.minute();
+  }
+  report("RTC_DS3231::now()         ", (micros() - start) / ROUNDS, 3 + 7);
+
+  // Address+W, register pointer, address+R, then seconds, minutes, hours
+  start = micros();
+  for (int i = 0; i < ROUNDS; i++) {
+    sink = rtcClock.readSecondOfDay() / 60;
+  }
+  report("RtcClock::readSecondOfDay()", (micros() - start) / ROUNDS, 3 + 3);
+
+  // What the loop pays per pass: mostly interpolation, a queued 3-register
+  // read once per second
+  start = micros();
+  for (int i = 0; i < ROUNDS * 10; i++) {
+    rtcClock.tick();
+    sink = rtcClock.minuteOfDay();
+  }
+  report("RtcClock::tick()          ", (micros() - start) / (ROUNDS * 10), 0);
+}
+
+void loop() {
+}
@@ -0,0 +1,60 @@
+#include "RtcSleep.h"
+#include <PinChange.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+RtcSleep::RtcSleep(RTC_DS3231 &rtc) : _rtc(rtc), _intPin(0xFF), _keepAwake(0) {
+}
+
+void RtcSleep::setKeepAwake(bool (*keepAwake)()) {
+  _keepAwake = keepAwake;
+}
+
+void RtcSleep::begin(uint8_t intPin) {
+  _intPin = intPin;
+  pinMode(_intPin, INPUT_PULLUP);
+
+  // INTCN = 1: the alarms drive INT/SQW instead of the square wave
+  _rtc.writeSqwPinMode(DS3231_OFF);
+  _rtc.disableAlarm(2);
+  _rtc.clearAlarm(1);
+  _rtc.clearAlarm(2);
+}
+
+void RtcSleep::sleepUntil(const DateTime &now, const DateTime &wake) {
+  if (_intPin == 0xFF || wake.unixtime() <= now.unixtime()) {
+    return;
+  }
+
+  // Match date, hours, minutes and seconds so long sleeps cannot alias
+  _rtc.clearAlarm(1);
+  if (!_rtc.setAlarm1(wake, DS3231_A1_Date)) {
+    return;
+  }
+
+  pinChangeEnable(_intPin, true);
+
+  uint8_t adcsra = ADCSRA;
+  ADCSRA = 0;
+  set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+
+  // Only sleep if the alarm has not fired already and nothing needs the
+  // timers. The instruction after SEI always executes, so a wake-up interrupt
+  // cannot slip in before SLEEP, and the BOD disable sequence must be
+  // followed by SLEEP within three cycles.
+  cli();
+  if (digitalRead(_intPin) == HIGH && !(_keepAwake && _keepAwake())) {
+    sleep_enable();
+#if defined(BODS) && defined(BODSE)
+    sleep_bod_disable();
+#endif
+    sei();
+    sleep_cpu();
+    sleep_disable();
+  }
+  sei();
+
+  ADCSRA = adcsra;
+  pinChangeEnable(_intPin, false);
+  _rtc.clearAlarm(1);
+}
@@ -0,0 +1,34 @@
+#ifndef RtcSleep_h
+#define RtcSleep_h
+
+#include <Arduino.h>
+#include <RTClib.h>
+
+// Power-down sleep timed by the DS3231.
+//
+// sleepUntil() programs Alarm1 for the wake-up time and puts the ATmega into
+// SLEEP_MODE_PWR_DOWN with the ADC off. The DS3231 INT/SQW output (open
+// drain, active low) is enabled as a pin-change interrupt for the duration,
+// since pin changes are the only wake sources that work in power-down; any
+// other pin-change interrupt left enabled (the Buttons library keeps its
+// pins on) wakes it as well. Timer0 stops while asleep, so millis() does not
+// advance; callers must re-read the RTC after waking.
+class RtcSleep {
+public:
+  RtcSleep(RTC_DS3231 &rtc);
+
+  // intPin is the MCU pin wired to the DS3231 INT/SQW output
+  void begin(uint8_t intPin);
+  // Called with interrupts off right before sleeping; returning true cancels
+  // the sleep, e.g. while an interrupt-driven debounce is still running
+  void setKeepAwake(bool (*keepAwake)());
+  // Returns without sleeping if the wake-up time is not in the future
+  void sleepUntil(const DateTime &now, const DateTime &wake);
+
+private:
+  RTC_DS3231 &_rtc;
+  uint8_t _intPin;
+  bool (*_keepAwake)();
+};
+
+#endif
@@ -0,0 +1,229 @@
+#include "TwiQueue.h"
+#include <avr/interrupt.h>
+#include <util/twi.h>
+
+// TWCR values; TWINT is written as 1 to clear it and let the hardware go on
+const uint8_t TWCR_NEXT = _BV(TWINT) | _BV(TWEN) | _BV(TWIE);
+const uint8_t TWCR_START = TWCR_NEXT | _BV(TWSTA);
+const uint8_t TWCR_STOP = _BV(TWINT) | _BV(TWEN) | _BV(TWSTO);
+
+// Polls of TWSTO in about a millisecond, far longer than a STOP takes
+const uint16_t STOP_SPINS = F_CPU / 8000;
+
+TwiQueue twiQueue;
+
+// Fires once per START, address byte and data byte
+ISR(TWI_vect) {
+  twiQueue.service();
+}
+
+TwiQueue::TwiQueue() : _head(0), _count(0), _index(0), _reading(false) {
+#ifdef TWI_QUEUE_PROFILE
+  memset(&_stats, 0, sizeof(_stats));
+#endif
+}
+
+void TwiQueue::begin() {
+  if (busy()) {
+    return;
+  }
+  // Internal pull-ups on SDA and SCL
+  digitalWrite(SDA, HIGH);
+  digitalWrite(SCL, HIGH);
+  if (TWBR == 0) {
+    setFrequency(TWI_QUEUE_FREQUENCY);
+  }
+  TWCR = _BV(TWEN);
+}
+
+void TwiQueue::setFrequency(uint32_t frequency) {
+  TWSR &= ~(_BV(TWPS0) | _BV(TWPS1));
+  TWBR = ((F_CPU / frequency) - 16) / 2;
+}
+
+void TwiQueue::submit(TwiTransaction &transaction) {
+  transaction.status = TWI_PENDING;
+
+  // Full: wait for the interrupt to finish one
+  unsigned long since = millis();
+  while (_count == TWI_QUEUE_SIZE) {
+    expire(since);
+  }
+
+  uint8_t oldSREG = SREG;
+  cli();
+  _queue[_head] = &transaction;
+  _head = (_head + 1) % TWI_QUEUE_SIZE;
+  _count++;
+  if (_count == 1) {
+    // The bus was idle; the STOP of the last transaction may still be going out.
+    // Interrupts are off, so millis() stands still: count polls instead, and
+    // restart the TWI if the STOP never clears
+    for (uint16_t spins = 0; TWCR & _BV(TWSTO); spins++) {
+      if (spins == STOP_SPINS) {
+        TWCR = 0;
+        TWCR = _BV(TWEN);
+        break;
+      }
+    }
+    start();
+    TWCR = TWCR_START;
+  }
+  SREG = oldSREG;
+}
+
+uint8_t TwiQueue::transfer(TwiTransaction &transaction) {
+  submit(transaction);
+  wait(transaction);
+  return transaction.status;
+}
+
+void TwiQueue::wait(TwiTransaction &transaction) {
+  unsigned long since = millis();
+  while (transaction.status == TWI_PENDING) {
+    expire(since);
+  }
+}
+
+bool TwiQueue::busy() {
+  return _count > 0;
+}
+
+void TwiQueue::flush() {
+  unsigned long since = millis();
+  while (busy()) {
+    expire(since);
+  }
+}
+
+// Give up on a hung bus once a wait that began at `since` has run out: reset
+// the TWI and fail every queued transaction, so the wait returns
+void TwiQueue::expire(unsigned long since) {
+  if (millis() - since < TWI_QUEUE_TIMEOUT) {
+    return;
+  }
+  uint8_t oldSREG = SREG;
+  cli();
+  TWCR = 0;
+  while (_count > 0) {
+    TwiTransaction &transaction = *_queue[(_head + TWI_QUEUE_SIZE - _count) % TWI_QUEUE_SIZE];
+    _count--;
+    transaction.status = TWI_TIMEOUT;
+    if (transaction.done) {
+      transaction.done(transaction);
+    }
+  }
+  SREG = oldSREG;
+  begin();
+}
+
+// Set up for the transaction at the tail, just before its START goes out
+void TwiQueue::start() {
+  TwiTransaction &transaction = *_queue[(_head + TWI_QUEUE_SIZE - _count) % TWI_QUEUE_SIZE];
+  _index = 0;
+  _reading = transaction.writeLength == 0 && transaction.readLength > 0;
+#ifdef TWI_QUEUE_PROFILE
+  _startedAt = micros();
+#endif
+}
+
+/**
+ * The function `service` moves the active transaction one step on from the TWI status code: it
+ * sends the address or the next byte, stores a received byte, or ends the transaction.
+ */
+void TwiQueue::service() {
+#ifdef TWI_QUEUE_PROFILE
+  uint16_t enteredAt = micros();
+#endif
+  TwiTransaction &transaction = *_queue[(_head + TWI_QUEUE_SIZE - _count) % TWI_QUEUE_SIZE];
+  uint8_t status = TW_STATUS;
+
+  switch (status) {
+    case TW_START:
+    case TW_REP_START:
+      _index = 0;
+      TWDR = (transaction.address << 1) | (_reading ? TW_READ : TW_WRITE);
+      TWCR = TWCR_NEXT;
+      break;
+
+    case TW_MT_SLA_ACK:
+    case TW_MT_DATA_ACK:
+      if (_index < transaction.writeLength) {
+        TWDR = transaction.writeData[_index++];
+        TWCR = TWCR_NEXT;
+      } else if (transaction.readLength > 0) {
+        _reading = true;
+        TWCR = TWCR_START;
+      } else {
+        finish(TWI_OK);
+      }
+      break;
+
+    case TW_MR_DATA_ACK:
+      transaction.readData[_index++] = TWDR;
+      // Fall through
+    case TW_MR_SLA_ACK:
+      // ACK every byte but the last, so the slave lets go of the bus after it
+      TWCR = TWCR_NEXT | (_index + 1 < transaction.readLength ? _BV(TWEA) : 0);
+      break;
+
+    case TW_MR_DATA_NACK:
+      transaction.readData[_index++] = TWDR;
+      finish(TWI_OK);
+      break;
+
+    case TW_MT_SLA_NACK:
+    case TW_MR_SLA_NACK:
+      finish(TWI_NACK_ADDRESS);
+      break;
+
+    case TW_MT_DATA_NACK:
+      finish(TWI_NACK_DATA);
+      break;
+
+    default:
+      // Lost arbitration or bus error
+      finish(TWI_ERROR);
+      break;
+  }
+
+#ifdef TWI_QUEUE_PROFILE
+  // Every status but a (repeated) START reports a byte that went over the bus
+  if (status != TW_START && status != TW_REP_START) {
+    _stats.bytes++;
+  }
+  // In 16 bits, so a micros() wrap inside the interrupt does not go negative
+  _stats.isrMicros += (uint16_t)((uint16_t)micros() - enteredAt);
+#endif
+}
+
+// End the active transaction with a STOP, and START the next one right behind it
+void TwiQueue::finish(uint8_t status) {
+  TwiTransaction &transaction = *_queue[(_head + TWI_QUEUE_SIZE - _count) % TWI_QUEUE_SIZE];
+  _count--;
+#ifdef TWI_QUEUE_PROFILE
+  _stats.transactions++;
+  _stats.busMicros += micros() - _startedAt;
+#endif
+
+  transaction.status = status;
+  if (transaction.done) {
+    transaction.done(transaction);
+  }
+
+  if (_count > 0) {
+    start();
+    TWCR = TWCR_START | _BV(TWSTO);
+  } else {
+    TWCR = TWCR_STOP;
+  }
+}
+
+#ifdef TWI_QUEUE_PROFILE
+void TwiQueue::stats(TwiStats &stats) {
+  uint8_t oldSREG = SREG;
+  cli();
+  stats = _stats;
+  SREG = oldSREG;
+}
+#endif
@@ -0,0 +1,123 @@
+#ifndef TwiQueue_h
+#define TwiQueue_h
+
+#include <Arduino.h>
+
+// Transactions waiting for the bus at once, including the one in progress
+#ifndef TWI_QUEUE_SIZE
+#define TWI_QUEUE_SIZE 4
+#endif
+
+// SCL frequency set by begin() unless setFrequency() (or Wire.setClock()) was
+// called first
+#ifndef TWI_QUEUE_FREQUENCY
+#define TWI_QUEUE_FREQUENCY 100000
+#endif
+
+// Milliseconds any wait on the queue may take before the bus counts as hung;
+// a full queue of 32-byte transactions clears in about 13 ms at 100 kHz
+#ifndef TWI_QUEUE_TIMEOUT
+#define TWI_QUEUE_TIMEOUT 25
+#endif
+
+// TwiTransaction::status
+const uint8_t TWI_OK = 0;
+const uint8_t TWI_NACK_ADDRESS = 2;  // Same codes as Wire.endTransmission()
+const uint8_t TWI_NACK_DATA = 3;
+const uint8_t TWI_ERROR = 4;         // Bus error or lost arbitration
+const uint8_t TWI_TIMEOUT = 5;       // The bus hung and was reset
+const uint8_t TWI_PENDING = 0xFF;    // Queued or on the bus
+
+struct TwiTransaction;
+typedef void (*TwiCallback)(TwiTransaction &transaction);
+
+// One master transfer: writeLength bytes from writeData, then, after a
+// repeated start, readLength bytes into readData. Either part may be empty.
+// The transaction and both buffers belong to the caller and must stay put
+// until status leaves TWI_PENDING.
+struct TwiTransaction {
+  uint8_t address;           // 7-bit slave address
+  const uint8_t *writeData;
+  uint8_t writeLength;
+  uint8_t *readData;
+  uint8_t readLength;
+  TwiCallback done;          // Called from the TWI interrupt when finished (from the
+                             // loop on a timeout), may be 0; it must not submit()
+  void *context;             // For the callback
+  volatile uint8_t status;
+};
+
+// Bus statistics since begin(), for the TWI_QUEUE_PROFILE builds
+struct TwiStats {
+  uint32_t transactions;
+  uint32_t bytes;            // Address and data bytes on the wire
+  uint32_t busMicros;        // START to STOP, summed over all transactions
+  uint32_t isrMicros;        // Time spent in the TWI interrupt
+};
+
+// Interrupt-driven TWI (I2C) master with a transaction queue.
+//
+// Wire blocks for the whole transfer: at 100 kHz every byte costs the CPU
+// 90 us of spinning on TWINT. submit() only queues the transaction; the TWI
+// interrupt then moves one byte per TWINT, chains queued transactions with a
+// STOP+START, and reports the result through status and the callback. The
+// loop keeps running while the LCD frame and the RTC reads are on the bus.
+//
+// The library also implements the twi_* layer under Wire (TwiWire.cpp), so
+// Wire calls made by LiquidCrystal_I2C, RTClib and friends become blocking
+// transactions in the same queue, in order with the asynchronous ones. Wire's
+// own twi.c, which would define the same vector, is then not linked (this
+// library is linked as objects, see library.json). Transactions always end
+// with a STOP, also where Wire asks for a repeated start; a device keeps its
+// register pointer across it, and submissions only come from the main loop,
+// so nothing gets in between.
+//
+// No wait lasts longer than TWI_QUEUE_TIMEOUT: a slave holding SDA low or a
+// transfer that never ends would otherwise hang the loop with a valve open.
+// On a timeout the TWI is reset and every queued transaction fails with
+// TWI_TIMEOUT.
+class TwiQueue {
+public:
+  TwiQueue();
+
+  // Enable the TWI with the internal pull-ups
+  void begin();
+  void setFrequency(uint32_t frequency);
+
+  // Queue a transaction; waits only while the queue is full
+  void submit(TwiTransaction &transaction);
+  // Queue a transaction and wait for it; returns its status
+  uint8_t transfer(TwiTransaction &transaction);
+  // Wait for a submitted transaction (needs interrupts enabled)
+  void wait(TwiTransaction &transaction);
+  // True while a transaction is queued or on the bus
+  bool busy();
+  // Wait until the bus is idle, e.g. before sleeping
+  void flush();
+
+#ifdef TWI_QUEUE_PROFILE
+  void stats(TwiStats &stats);
+#endif
+
+  // Advance the transaction on the bus; called from the TWI interrupt
+  void service();
+
+private:
+  void start();
+  void finish(uint8_t status);
+  void expire(unsigned long since);
+
+  TwiTransaction *_queue[TWI_QUEUE_SIZE];
+  volatile uint8_t _head;     // Next free entry
+  volatile uint8_t _count;    // Entries waiting, including the active one
+  uint8_t _index;             // Next byte of the active transaction
+  bool _reading;              // Past the repeated start
+#ifdef TWI_QUEUE_PROFILE
+  uint32_t _startedAt;
+  TwiStats _stats;
+#endif
+};
+
+extern TwiQueue twiQueue;
+
+#endif
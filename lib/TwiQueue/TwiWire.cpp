@@ -0,0 +1,75 @@
+// The twi_* layer Wire is built on, implemented on the transaction queue so
+// Wire traffic and asynchronous transactions share the bus in order. Each
+// Wire call becomes one transaction and blocks until it is done, as before.
+// Only the master side is supported.
+
+#include "TwiQueue.h"
+
+extern "C" {
+#include <utility/twi.h>
+
+void twi_init(void) {
+  twiQueue.begin();
+}
+
+void twi_disable(void) {
+  twiQueue.flush();
+  TWCR = 0;
+  digitalWrite(SDA, LOW);
+  digitalWrite(SCL, LOW);
+}
+
+void twi_setAddress(uint8_t address) {
+  TWAR = address << 1;
+}
+
+void twi_setFrequency(uint32_t frequency) {
+  twiQueue.setFrequency(frequency);
+}
+
+// Returns the number of bytes read, 0 on a NACK or bus error
+uint8_t twi_readFrom(uint8_t address, uint8_t *data, uint8_t length, uint8_t sendStop) {
+  TwiTransaction transaction = { address, 0, 0, data, length, 0, 0, TWI_PENDING };
+  return twiQueue.transfer(transaction) == TWI_OK ? length : 0;
+}
+
+// Returns 0 on success, 1 if the data is too long, or the TWI_* error
+uint8_t twi_writeTo(uint8_t address, uint8_t *data, uint8_t length, uint8_t wait, uint8_t sendStop) {
+  if (length > TWI_BUFFER_LENGTH) {
+    return 1;
+  }
+  TwiTransaction transaction = { address, data, length, 0, 0, 0, 0, TWI_PENDING };
+  return twiQueue.transfer(transaction);
+}
+
+// Slave mode is not supported
+uint8_t twi_transmit(const uint8_t *data, uint8_t length) {
+  return 2;
+}
+
+void twi_attachSlaveRxEvent(void (*function)(uint8_t *, int)) {
+}
+
+void twi_attachSlaveTxEvent(void (*function)(void)) {
+}
+
+void twi_reply(uint8_t ack) {
+}
+
+void twi_stop(void) {
+}
+
+void twi_releaseBus(void) {
+}
+
+// The queue has its own timeout (TWI_QUEUE_TIMEOUT), reported as Wire's 5
+void twi_setTimeoutInMicros(uint32_t timeout, bool resetWithTimeout) {
+}
+
+void twi_handleTimeout(bool reset) {
+}
+
+bool twi_manageTimeoutFlag(bool clearFlag) {
+  return false;
+}
+}
@@ -0,0 +1,79 @@
+// Measures what the TWI queue saves the main loop at 100 kHz and 400 kHz:
+// how long a 16-character LCD row and a DS3231 time read keep the bus busy
+// (what a blocking Wire call costs the loop), how soon submit() returns, and
+// how much of the CPU the TWI interrupt takes while the transfer runs.
+
+#include <Wire.h>
+#include <TwiQueue.h>
+#include <BatchedLcd.h>
+
+const uint8_t LCD_ADDRESS = 0x27;
+const uint8_t RTC_ADDRESS = 0x68;
+const int ROUNDS = 20;
+const char row[] = "0123456789ABCDEF";
+
+BatchedLcd lcd(LCD_ADDRESS, 16, 2);
+
+const uint8_t timeRegister = 0;
+uint8_t timeRegisters[7];
+TwiTransaction rtcRead = { RTC_ADDRESS, &timeRegister, 1, timeRegisters, 7, 0, 0, TWI_OK };
+
+volatile uint32_t spins;
+
+// Busy-loop iterations per millisecond with the bus idle, same loop as below
+uint32_t idleSpinRate() {
+  spins = 0;
+  unsigned long start = micros();
+  while (!twiQueue.busy() && spins < 20000) {
+    spins++;
+  }
+  return spins * 1000UL / (micros() - start);
+}
+
+// Run one transfer ROUNDS times: bus time, time until the call returns and
+// the share of the CPU left to the loop while the transfer runs
+template <class Send> void measure(const char *name, uint32_t spinRate, Send send) {
+  unsigned long busMicros = 0;
+  unsigned long returnMicros = 0;
+  unsigned long loopSpins = 0;
+  for (int i = 0; i < ROUNDS; i++) {
+    spins = 0;
+    unsigned long start = micros();
+    send();
+    returnMicros += micros() - start;
+    while (twiQueue.busy()) {
+      spins++;
+    }
+    busMicros += micros() - start;
+    loopSpins += spins;
+  }
+  unsigned long expectedSpins = spinRate * (busMicros - returnMicros) / 1000;
+
+  Serial.print(name);
+  Serial.print(": bus ");
+  Serial.print(busMicros / ROUNDS);
+  Serial.print(" us, returns after ");
+  Serial.print(returnMicros / ROUNDS);
+  Serial.print(" us, loop keeps ");
+  Serial.print(expectedSpins ? 100.0 * loopSpins / expectedSpins : 0, 1);
+  Serial.println("% of the CPU meanwhile");
+}
+
+void setup() {
+  Serial.begin(9600);
+  lcd.init();
+  lcd.backlight();
+  uint32_t spinRate = idleSpinRate();
+
+  const uint32_t frequencies[] = { 100000, 400000 };
+  for (uint8_t f = 0; f < 2; f++) {
+    twiQueue.setFrequency(frequencies[f]);
+    Serial.print(frequencies[f] / 1000);
+    Serial.println(" kHz");
+    measure("  LCD row ", spinRate, []() { lcd.writeAt(0, 0, (const uint8_t *)row, 16); });
+    measure("  RTC read", spinRate, []() { twiQueue.submit(rtcRead); });
+  }
+}
+
+void loop() {
+}
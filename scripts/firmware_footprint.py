@@ -0,0 +1,95 @@
+# PlatformIO post-build script: report the flash and RAM used by the board
+# profile being built, and what the zone table costs in RAM and EEPROM, after
+# every link. The build fails when the static RAM (data + bss) goes over the
+# MCU's budget below, or when Wire's TWI driver got linked next to
+# TwiQueue's; the storage budgets are enforced by the static_asserts in
+# lib/IrrigationCore/Irrigation.h and lib/IrrigationBoard.
+#
+#   extra_scripts = post:../scripts/firmware_footprint.py
+
+import os
+import subprocess
+
+Import("env")
+
+ZONE_SYMBOLS = ("zones", "zoneRuns")
+
+# lib/TwiQueue replaces the twi_* layer under Wire (TwiWire.cpp). These
+# statics only exist in Wire's own twi.c, so finding one next to twiQueue
+# means both drivers were linked and fight over TWI_vect.
+WIRE_TWI_SYMBOLS = ("twi_state", "twi_masterBuffer")
+
+# Static RAM each MCU may spend on data + bss; the rest is left for the
+# stack, which the compiler cannot check. Other MCUs keep a quarter free.
+RAM_BUDGETS = {
+    "atmega168": 1024 - 256,
+    "atmega328p": 2048 - 512,
+}
+
+
+def binutil(env, name):
+    # avr-gcc -> avr-nm, gcc -> nm
+    return env.subst("$CC")[:-len("gcc")] + name
+
+
+def report_profile_footprint(source, target, env):
+    output = subprocess.check_output(
+        [binutil(env, "size"), str(target[0])], env=env["ENV"]
+    ).decode()
+    text, data, bss = [int(field) for field in output.splitlines()[1].split()[:3]]
+
+    board = env.BoardConfig()
+    flash_max = int(board.get("upload.maximum_size", 0))
+    ram_max = int(board.get("upload.maximum_ram_size", 0))
+    profiles = [
+        flag for flag in env.get("CPPDEFINES", [])
+        if isinstance(flag, str) and (flag.startswith("BOARD_") or flag == "LOW_POWER_SLEEP")
+    ]
+    mcu = board.get("build.mcu", "")
+    ram_budget = RAM_BUDGETS.get(mcu, ram_max * 3 // 4)
+    print(
+        "Profile %s (%s): flash %d of %d bytes, RAM %d of %d bytes (budget %d)"
+        % (env["PIOENV"], " ".join(profiles), text + data, flash_max, data + bss, ram_max, ram_budget)
+    )
+    if data + bss > ram_budget:
+        # Remove the image so the next build links and checks it again
+        os.remove(str(target[0]))
+        print("Static RAM is %d bytes over the %s budget" % (data + bss - ram_budget, mcu))
+        env.Exit(1)
+
+
+def report_zone_footprint(source, target, env):
+    output = subprocess.check_output(
+        [binutil(env, "nm"), "--print-size", "--demangle", str(target[0])], env=env["ENV"]
+    ).decode()
+
+    sizes = {}
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) == 4 and fields[3] in ZONE_SYMBOLS:
+            sizes[fields[3]] = int(fields[1], 16)
+
+    if "zones" not in sizes:
+        print("Zone table: symbols not found in %s" % target[0])
+        return
+    ram = sum(sizes.values())
+    print(
+        "Zone table: %d bytes RAM (zones %d, zoneRuns %d), %d bytes EEPROM"
+        % (ram, sizes["zones"], sizes.get("zoneRuns", 0), sizes["zones"])
+    )
+
+
+def check_twi_driver(source, target, env):
+    output = subprocess.check_output(
+        [binutil(env, "nm"), "--demangle", str(target[0])], env=env["ENV"]
+    ).decode()
+    symbols = set(line.split()[-1] for line in output.splitlines() if line.strip())
+    if "twiQueue" in symbols and symbols.intersection(WIRE_TWI_SYMBOLS):
+        os.remove(str(target[0]))
+        print("Wire's twi.c is linked next to TwiQueue; check that TwiQueue is linked as objects (library.json)")
+        env.Exit(1)
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", check_twi_driver)
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", report_profile_footprint)
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", report_zone_footprint)
@@ -0,0 +1,248 @@
+// Cycle-accurate benchmark of the firmware under simavr.
+//
+// Runs an AVR ELF with a PCF8574 (LCD backpack) and a DS3231 on the TWI and
+// measures, over N passes of loop(), the cycles spent in each function given
+// with --function (inclusive of callees and of interrupts that hit while it
+// runs) and the I2C bytes sent to each device. The table goes to stdout as
+// CSV; simavr_bench.py resolves the function addresses and runs it.
+//
+//   simavr_bench [--mcu atmega328p] [--freq 16000000] [--loops 100]
+//                [--warmup 2] [--time 1735718400] [--high B2,B3,B4]
+//                --function loop=0x1a2 [--function name=0xaddr ...] firmware.elf
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_avr.h"
+#include "sim_elf.h"
+#include "sim_core.h"
+#include "avr_ioport.h"
+#include "twi_models.h"
+
+#define MAX_FUNCTIONS 32
+#define MAX_DEPTH 64
+
+typedef struct function_t {
+  const char *name;
+  avr_flashaddr_t address;
+  unsigned long calls;
+  avr_cycle_count_t cycles;
+} function_t;
+
+// A function being run: entered with this SP, at this cycle
+typedef struct frame_t {
+  function_t *function;
+  uint16_t sp;
+  avr_cycle_count_t entered;
+} frame_t;
+
+static function_t functions[MAX_FUNCTIONS];
+static int functionCount;
+static frame_t frames[MAX_DEPTH];
+static int depth;
+
+static uint16_t stack_pointer(avr_t *avr) {
+  return avr->data[R_SPL] | avr->data[R_SPH] << 8;
+}
+
+static function_t *function_at(avr_flashaddr_t pc) {
+  for (int i = 0; i < functionCount; i++) {
+    if (functions[i].address == pc) {
+      return &functions[i];
+    }
+  }
+  return NULL;
+}
+
+// A return (or a longjmp) put SP above the entry SP of the frames it left;
+// a tail call enters the next function with the same SP and leaves with it
+static void leave_frames(avr_t *avr, int counting, avr_cycle_count_t measuredFrom) {
+  uint16_t sp = stack_pointer(avr);
+  while (depth > 0 && sp > frames[depth - 1].sp) {
+    depth--;
+    if (counting && frames[depth].entered >= measuredFrom) {
+      frames[depth].function->cycles += avr->cycle - frames[depth].entered;
+    }
+  }
+}
+
+static void usage(const char *program) {
+  fprintf(stderr,
+          "usage: %s [--mcu name] [--freq hz] [--loops n] [--warmup n] [--time unixtime]\n"
+          "          [--high PORTBIT,...] --function loop=0xaddr [--function name=0xaddr ...] elf\n",
+          program);
+  exit(2);
+}
+
+// Drive the listed input pins high, e.g. "B2,D6": the buttons are read with
+// pull-ups, which the simulator does not provide, so an idle button is high
+static void raise_pins(avr_t *avr, const char *pins) {
+  char *list = strdup(pins);
+  for (char *pin = strtok(list, ","); pin; pin = strtok(NULL, ",")) {
+    if (strlen(pin) != 2 || pin[1] < '0' || pin[1] > '7') {
+      fprintf(stderr, "bad pin '%s'\n", pin);
+      exit(2);
+    }
+    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(pin[0]), pin[1] - '0'), 1);
+  }
+  free(list);
+}
+
+int main(int argc, char *argv[]) {
+  const char *mcu = NULL;
+  uint32_t frequency = 0;
+  unsigned long loops = 100;
+  unsigned long warmup = 2;
+  uint32_t startTime = 1735718400;  // 2025-01-01 08:00:00, inside the factory window
+  const char *high = NULL;
+
+  static const struct option options[] = {
+    { "mcu", required_argument, NULL, 'm' },
+    { "freq", required_argument, NULL, 'f' },
+    { "loops", required_argument, NULL, 'n' },
+    { "warmup", required_argument, NULL, 'w' },
+    { "time", required_argument, NULL, 't' },
+    { "high", required_argument, NULL, 'h' },
+    { "function", required_argument, NULL, 'F' },
+    { NULL, 0, NULL, 0 },
+  };
+  int option;
+  while ((option = getopt_long(argc, argv, "", options, NULL)) != -1) {
+    switch (option) {
+      case 'm': mcu = optarg; break;
+      case 'f': frequency = strtoul(optarg, NULL, 0); break;
+      case 'n': loops = strtoul(optarg, NULL, 0); break;
+      case 'w': warmup = strtoul(optarg, NULL, 0); break;
+      case 't': startTime = strtoul(optarg, NULL, 0); break;
+      case 'h': high = optarg; break;
+      case 'F': {
+        char *equals = strchr(optarg, '=');
+        if (!equals || functionCount == MAX_FUNCTIONS) {
+          usage(argv[0]);
+        }
+        *equals = 0;
+        functions[functionCount].name = optarg;
+        functions[functionCount].address = strtoul(equals + 1, NULL, 0);
+        functionCount++;
+        break;
+      }
+      default: usage(argv[0]);
+    }
+  }
+  if (optind != argc - 1 || loops == 0) {
+    usage(argv[0]);
+  }
+
+  function_t *loop = NULL;
+  for (int i = 0; i < functionCount; i++) {
+    if (strcmp(functions[i].name, "loop") == 0) {
+      loop = &functions[i];
+    }
+  }
+  if (!loop) {
+    fprintf(stderr, "--function loop=0xaddr is required to count passes\n");
+    return 2;
+  }
+
+  elf_firmware_t firmware;
+  memset(&firmware, 0, sizeof(firmware));
+  if (elf_read_firmware(argv[optind], &firmware) != 0) {
+    fprintf(stderr, "cannot read %s\n", argv[optind]);
+    return 1;
+  }
+  if (mcu) {
+    strncpy(firmware.mmcu, mcu, sizeof(firmware.mmcu) - 1);
+  }
+  if (frequency) {
+    firmware.frequency = frequency;
+  }
+  if (!firmware.mmcu[0]) {
+    strcpy(firmware.mmcu, "atmega328p");
+  }
+  if (!firmware.frequency) {
+    firmware.frequency = 16000000;
+  }
+
+  avr_t *avr = avr_make_mcu_by_name(firmware.mmcu);
+  if (!avr) {
+    fprintf(stderr, "unknown MCU %s\n", firmware.mmcu);
+    return 1;
+  }
+  avr_init(avr);
+  avr_load_firmware(avr, &firmware);
+
+  pcf8574_t lcd;
+  ds3231_t rtc;
+  pcf8574_init(&lcd, "pcf8574", 0x27);
+  ds3231_init(&rtc, avr, 0x68, startTime);
+  i2c_device_t *devices[] = { &lcd.device, &rtc.device };
+  twi_bus_attach(avr, devices, 2);
+  if (high) {
+    raise_pins(avr, high);
+  }
+
+  // Passes of loop() started; counting covers passes warmup+1 to warmup+loops
+  unsigned long passes = 0;
+  int counting = 0;
+  avr_cycle_count_t measuredFrom = 0;
+  unsigned long bytesFrom[2] = { 0, 0 };
+
+  int state = cpu_Running;
+  while (state != cpu_Done && state != cpu_Crashed) {
+    state = avr_run(avr);
+    leave_frames(avr, counting, measuredFrom);
+
+    function_t *function = function_at(avr->pc);
+    if (!function) {
+      continue;
+    }
+    if (function == loop) {
+      passes++;
+      if (passes == warmup + 1) {
+        counting = 1;
+        measuredFrom = avr->cycle;
+        for (int i = 0; i < 2; i++) {
+          bytesFrom[i] = devices[i]->bytes;
+        }
+      } else if (passes == warmup + loops + 1) {
+        break;
+      }
+    }
+    if (depth == MAX_DEPTH) {
+      fprintf(stderr, "call depth over %d at %s\n", MAX_DEPTH, function->name);
+      return 1;
+    }
+    frames[depth].function = function;
+    frames[depth].sp = stack_pointer(avr);
+    frames[depth].entered = avr->cycle;
+    depth++;
+    if (counting) {
+      function->calls++;
+    }
+  }
+  if (!counting || passes < warmup + loops + 1) {
+    fprintf(stderr, "firmware stopped after %lu passes of loop() (state %d)\n", passes, state);
+    return 1;
+  }
+
+  // Only calls that returned inside the window are counted; loop() returned
+  // `loops` times, and the window adds main()'s work between the passes
+  avr_cycle_count_t measured = avr->cycle - measuredFrom;
+  printf("metric,name,count,total,per_call,per_loop\n");
+  printf("cycles,window,%lu,%llu,,%.1f\n", loops, (unsigned long long)measured,
+         (double)measured / loops);
+  for (int i = 0; i < functionCount; i++) {
+    function_t *function = &functions[i];
+    printf("cycles,%s,%lu,%llu,%.1f,%.1f\n", function->name, function->calls,
+           (unsigned long long)function->cycles,
+           function->calls ? (double)function->cycles / function->calls : 0.0,
+           (double)function->cycles / loops);
+  }
+  for (int i = 0; i < 2; i++) {
+    unsigned long bytes = devices[i]->bytes - bytesFrom[i];
+    printf("i2c_bytes,%s,%lu,%lu,,%.2f\n", devices[i]->name, bytes, bytes, (double)bytes / loops);
+  }
+  printf("clock,hz,,%u,,\n", (unsigned)firmware.frequency);
+  return 0;
+}
@@ -0,0 +1,109 @@
+# PlatformIO extra script: `pio run -e simavr_bench -t bench` builds the
+# firmware, builds the simavr harness next to it and runs the ELF under
+# simavr with a PCF8574 and a DS3231 on the bus. It prints a CSV table of
+# cycles per function and I2C bytes per pass of loop() (see simavr_bench.c).
+#
+#   extra_scripts = post:../../scripts/simavr_bench/simavr_bench.py
+#   custom_bench_loops = 100
+#
+# Needs simavr with its headers and libelf (Debian: libsimavr-dev).
+
+import inspect
+import os
+import subprocess
+
+Import("env")
+
+HARNESS_DIR = os.path.dirname(os.path.abspath(inspect.getfile(inspect.currentframe())))
+HARNESS_SOURCES = ("simavr_bench.c", "twi_models.c")
+
+# Demangled names of the measured functions; loop is required
+FUNCTIONS = (
+    "loop",
+    "irrigationLoop",
+    "displayTimeAndSettings",
+    "checkIrrigation",
+    "updateIrrigation",
+    "halIdle",
+    "RtcClock::tick",
+    "LcdFrame::flush",
+    "TwiQueue::service",
+    "RTC_DS3231::now",
+)
+
+# Button pins of each profile (lib/BoardConfig/BoardConfig.h), held high as
+# the pull-ups would
+BUTTON_PINS = {
+    "BOARD_JUDE": "B2,B3,B4",
+    "BOARD_NOEL": "B0,D6,D5",
+}
+
+
+def binutil(env, name):
+    # avr-gcc -> avr-nm
+    return env.subst("$CC")[:-len("gcc")] + name
+
+
+def function_addresses(env, elf):
+    output = subprocess.check_output(
+        [binutil(env, "nm"), "--demangle", "--defined-only", elf], env=env["ENV"]
+    ).decode()
+    addresses = {}
+    for line in output.splitlines():
+        fields = line.split(None, 2)
+        if len(fields) != 3 or fields[1] not in "tT":
+            continue
+        # Overloads and argument lists: "RtcClock::tick()" -> "RtcClock::tick"
+        name = fields[2].split("(")[0]
+        if name in FUNCTIONS and name not in addresses:
+            addresses[name] = int(fields[0], 16)
+    return addresses
+
+
+def build_harness(env):
+    harness = os.path.join(env.subst("$BUILD_DIR"), "simavr_bench")
+    sources = [os.path.join(HARNESS_DIR, source) for source in HARNESS_SOURCES]
+    try:
+        flags = subprocess.check_output(
+            ["pkg-config", "--cflags", "--libs", "simavr"]
+        ).decode().split() + ["-lelf"]
+    except (OSError, subprocess.CalledProcessError):
+        flags = ["-I/usr/include/simavr", "-lsimavr", "-lelf"]
+    subprocess.check_call(["cc", "-O2", "-o", harness] + sources + flags)
+    return harness
+
+
+def run_bench(target, source, env):
+    elf = env.subst("$BUILD_DIR/${PROGNAME}.elf")
+    addresses = function_addresses(env, elf)
+    if "loop" not in addresses:
+        print("simavr_bench: loop() not found in %s" % elf)
+        return 1
+    for name in FUNCTIONS:
+        if name not in addresses:
+            print("simavr_bench: %s not in the ELF (inlined or not linked)" % name)
+
+    board = env.BoardConfig()
+    command = [
+        build_harness(env),
+        "--mcu", board.get("build.mcu"),
+        "--freq", board.get("build.f_cpu").rstrip("L"),
+        "--loops", str(env.GetProjectOption("custom_bench_loops", "100")),
+    ]
+    for define, pins in BUTTON_PINS.items():
+        if define in env.get("CPPDEFINES", []):
+            command += ["--high", pins]
+    for name in FUNCTIONS:
+        if name in addresses:
+            command += ["--function", "%s=0x%x" % (name, addresses[name])]
+    command.append(elf)
+    return subprocess.call(command)
+
+
+env.AddCustomTarget(
+    name="bench",
+    dependencies="$BUILD_DIR/${PROGNAME}.elf",
+    actions=[run_bench],
+    title="simavr benchmark",
+    description="Cycles per function and I2C bytes per loop() pass under simavr",
+)
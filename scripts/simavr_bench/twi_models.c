@@ -0,0 +1,135 @@
+#include <string.h>
+#include <time.h>
+#include "avr_twi.h"
+#include "sim_irq.h"
+#include "twi_models.h"
+
+static struct {
+  avr_irq_t *irq;
+  i2c_device_t *devices[TWI_BUS_DEVICES];
+  int count;
+  i2c_device_t *selected;
+  uint8_t selectedAddress;  // 8-bit, as in the TWI messages
+} bus;
+
+static void pcf8574_write(i2c_device_t *device, uint8_t data) {
+  ((pcf8574_t *)device)->port = data;
+}
+
+static uint8_t pcf8574_read(i2c_device_t *device) {
+  return ((pcf8574_t *)device)->port;
+}
+
+void pcf8574_init(pcf8574_t *pcf, const char *name, uint8_t address) {
+  memset(pcf, 0, sizeof(*pcf));
+  pcf->device.name = name;
+  pcf->device.address = address;
+  pcf->device.write = pcf8574_write;
+  pcf->device.read = pcf8574_read;
+  pcf->port = 0xFF;
+}
+
+static uint8_t bcd(int value) {
+  return (value / 10) << 4 | value % 10;
+}
+
+// Latch the current simulated time into the time registers
+static void ds3231_start(i2c_device_t *device, int read) {
+  ds3231_t *rtc = (ds3231_t *)device;
+  time_t now = rtc->start_time + rtc->avr->cycle / rtc->avr->frequency;
+  struct tm tm;
+  gmtime_r(&now, &tm);
+  rtc->registers[0] = bcd(tm.tm_sec);
+  rtc->registers[1] = bcd(tm.tm_min);
+  rtc->registers[2] = bcd(tm.tm_hour);  // 24-hour mode
+  rtc->registers[3] = tm.tm_wday + 1;
+  rtc->registers[4] = bcd(tm.tm_mday);
+  rtc->registers[5] = bcd(tm.tm_mon + 1);
+  rtc->registers[6] = bcd(tm.tm_year - 100);
+  rtc->pointer_set = read;
+}
+
+static void ds3231_write(i2c_device_t *device, uint8_t data) {
+  ds3231_t *rtc = (ds3231_t *)device;
+  if (!rtc->pointer_set) {
+    rtc->pointer = data % sizeof(rtc->registers);
+    rtc->pointer_set = 1;
+    return;
+  }
+  rtc->registers[rtc->pointer] = data;
+  rtc->pointer = (rtc->pointer + 1) % sizeof(rtc->registers);
+}
+
+static uint8_t ds3231_read(i2c_device_t *device) {
+  ds3231_t *rtc = (ds3231_t *)device;
+  uint8_t data = rtc->registers[rtc->pointer];
+  rtc->pointer = (rtc->pointer + 1) % sizeof(rtc->registers);
+  return data;
+}
+
+void ds3231_init(ds3231_t *rtc, avr_t *avr, uint8_t address, uint32_t start_time) {
+  memset(rtc, 0, sizeof(*rtc));
+  rtc->device.name = "ds3231";
+  rtc->device.address = address;
+  rtc->device.start = ds3231_start;
+  rtc->device.write = ds3231_write;
+  rtc->device.read = ds3231_read;
+  rtc->avr = avr;
+  rtc->start_time = start_time;
+  rtc->registers[0x0E] = 0x1C;  // Control: INTCN, alarms off, as after power-up
+  rtc->registers[0x11] = 25;    // 25.00 degrees
+}
+
+// Messages the simulated TWI sends out: START with the address byte, each
+// written byte, and each byte the master wants to read
+static void twi_out_hook(struct avr_irq_t *irq, uint32_t value, void *param) {
+  avr_twi_msg_irq_t message;
+  message.u.v = value;
+
+  if (message.u.twi.msg & TWI_COND_STOP) {
+    bus.selected = NULL;
+  }
+
+  if (message.u.twi.msg & TWI_COND_START) {
+    bus.selected = NULL;
+    for (int i = 0; i < bus.count; i++) {
+      i2c_device_t *device = bus.devices[i];
+      if (device->address == message.u.twi.addr >> 1) {
+        bus.selected = device;
+        bus.selectedAddress = message.u.twi.addr;
+        device->bytes++;
+        if (device->start) {
+          device->start(device, message.u.twi.addr & 1);
+        }
+        avr_raise_irq(bus.irq + TWI_IRQ_INPUT, avr_twi_irq_msg(TWI_COND_ACK, bus.selectedAddress, 1));
+        break;
+      }
+    }
+  }
+
+  if (bus.selected == NULL) {
+    return;
+  }
+  if (message.u.twi.msg & TWI_COND_WRITE) {
+    bus.selected->bytes++;
+    bus.selected->write(bus.selected, message.u.twi.data);
+    avr_raise_irq(bus.irq + TWI_IRQ_INPUT, avr_twi_irq_msg(TWI_COND_ACK, bus.selectedAddress, 1));
+  }
+  if (message.u.twi.msg & TWI_COND_READ) {
+    bus.selected->bytes++;
+    uint8_t data = bus.selected->read(bus.selected);
+    avr_raise_irq(bus.irq + TWI_IRQ_INPUT, avr_twi_irq_msg(TWI_COND_READ, bus.selectedAddress, data));
+  }
+}
+
+void twi_bus_attach(avr_t *avr, i2c_device_t **devices, int count) {
+  static const char *names[] = { "twi.bus.out", "twi.bus.in" };
+  memset(&bus, 0, sizeof(bus));
+  bus.count = count < TWI_BUS_DEVICES ? count : TWI_BUS_DEVICES;
+  memcpy(bus.devices, devices, bus.count * sizeof(devices[0]));
+
+  bus.irq = avr_alloc_irq(&avr->irq_pool, 0, 2, names);
+  avr_irq_register_notify(bus.irq + TWI_IRQ_OUTPUT, twi_out_hook, NULL);
+  avr_connect_irq(bus.irq + TWI_IRQ_INPUT, avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_INPUT));
+  avr_connect_irq(avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_OUTPUT), bus.irq + TWI_IRQ_OUTPUT);
+}
@@ -0,0 +1,44 @@
+// I2C peripheral models for the simavr benchmark: the PCF8574 backpack of
+// the LCD and the DS3231 RTC, on the TWI of the simulated AVR. Each device
+// counts the bytes addressed to it (address and data bytes, as on the wire).
+#ifndef TWI_MODELS_H
+#define TWI_MODELS_H
+
+#include <stdint.h>
+#include "sim_avr.h"
+
+typedef struct i2c_device_t {
+  const char *name;
+  uint8_t address;    // 7-bit
+  void (*start)(struct i2c_device_t *device, int read);
+  void (*write)(struct i2c_device_t *device, uint8_t data);
+  uint8_t (*read)(struct i2c_device_t *device);
+  unsigned long bytes;
+} i2c_device_t;
+
+// PCF8574 I/O expander: the port is whatever was written last
+typedef struct pcf8574_t {
+  i2c_device_t device;
+  uint8_t port;
+} pcf8574_t;
+
+// DS3231 RTC: registers 0x00-0x12, the time running from start_time at the
+// simulated CPU clock. The time registers are latched on every START, like
+// the chip's own buffer.
+typedef struct ds3231_t {
+  i2c_device_t device;
+  avr_t *avr;
+  uint32_t start_time;  // Unixtime at cycle 0
+  uint8_t registers[0x13];
+  uint8_t pointer;
+  int pointer_set;      // The first byte written sets the register pointer
+} ds3231_t;
+
+void pcf8574_init(pcf8574_t *pcf, const char *name, uint8_t address);
+void ds3231_init(ds3231_t *rtc, avr_t *avr, uint8_t address, uint32_t start_time);
+
+// Connect the devices to the AVR's TWI; at most TWI_BUS_DEVICES
+#define TWI_BUS_DEVICES 8
+void twi_bus_attach(avr_t *avr, i2c_device_t **devices, int count);
+
+#endif